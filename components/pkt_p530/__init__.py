@@ -17,6 +17,9 @@ CODEOWNERS = ["@buglloc"]
 DEPENDENCIES = ["uart"]
 AUTO_LOAD = ["sensor", "binary_sensor"]
 
+CONF_BEEP = "beep"
+CONF_MAX_IN_FLIGHT = "max_in_flight"
+CONF_MAX_RETRIES = "max_retries"
 CONF_ON_MS = "on_ms"
 CONF_OFF_MS = "off_ms"
 CONF_PORTIONS = "portions"
@@ -39,6 +42,7 @@ InitAction = pkt_p530_ns.class_("InitAction", automation.Action)
 DoorOpenAction = pkt_p530_ns.class_("DoorOpenAction", automation.Action)
 DoorCloseAction = pkt_p530_ns.class_("DoorCloseAction", automation.Action)
 DispenseAction = pkt_p530_ns.class_("DispenseAction", automation.Action)
+FeedAction = pkt_p530_ns.class_("FeedAction", automation.Action)
 
 IsReadyCondition = pkt_p530_ns.class_("IsReadyCondition", automation.Condition)
 HasFoodCondition = pkt_p530_ns.class_("HasFoodCondition", automation.Condition)
@@ -48,6 +52,8 @@ CONFIG_SCHEMA = (
     cv.Schema(
         {
             cv.GenerateID(): cv.declare_id(P530Component),
+            cv.Optional(CONF_MAX_IN_FLIGHT, default=2): cv.int_range(min=1, max=8),
+            cv.Optional(CONF_MAX_RETRIES, default=2): cv.int_range(min=0, max=5),
         }
     )
     .extend(cv.COMPONENT_SCHEMA)
@@ -59,6 +65,8 @@ async def to_code(config: ConfigType):
     var = cg.new_Pvariable(config[CONF_ID])
     await cg.register_component(var, config)
     await uart.register_uart_device(var, config)
+    cg.add(var.set_max_in_flight(config[CONF_MAX_IN_FLIGHT]))
+    cg.add(var.set_max_retries(config[CONF_MAX_RETRIES]))
 
 
 # ============== Actions ==============
@@ -66,9 +74,9 @@ async def to_code(config: ConfigType):
 BASE_ACTION_SCHEMA = cv.Schema(
     {
         cv.GenerateID(): cv.use_id(P530Component),
-        cv.Optional(
-            CONF_SEND_TIMEOUT, default="1s"
-        ): cv.positive_time_period_milliseconds,
+        # without it, requests are retransmitted based on the measured ACK times. Once it expired the request is
+        # not retransmitted anymore, so a timeout below the retransmission timeout (1s at first) leaves no retries.
+        cv.Optional(CONF_SEND_TIMEOUT): cv.positive_time_period_milliseconds,
         cv.Optional(CONF_ON_COMPLETE): automation.validate_action_list,
         cv.Optional(CONF_ON_ERROR): automation.validate_action_list,
         cv.Optional(CONF_WAIT_FOR_COMPLETE, default=True): cv.boolean,
@@ -85,7 +93,8 @@ async def base_action_code(
     var = cg.new_Pvariable(action_id, template_arg)
     await cg.register_parented(var, config[CONF_ID])
 
-    cg.add(var.set_send_timeout(config[CONF_SEND_TIMEOUT]))
+    if CONF_SEND_TIMEOUT in config:
+        cg.add(var.set_send_timeout(config[CONF_SEND_TIMEOUT]))
     cg.add(var.set_wait_for_complete(config[CONF_WAIT_FOR_COMPLETE]))
 
     if on_complete_config := config.get(CONF_ON_COMPLETE):
@@ -210,6 +219,7 @@ async def pkt_p530_beep_ctl_to_code(config, action_id, template_arg, args):
 
 # ================ Feed actions ==============
 
+# the timeout is the minimum wait for the door, it is only extended when the measured door timing is longer
 DOOR_ACTION_SCHEMA = BASE_ACTION_SCHEMA.extend(
     {
         cv.Optional(CONF_DURATION, default=0x1E): cv.int_range(min=0, max=255),
@@ -249,6 +259,31 @@ async def pkt_p530_dispense_to_code(config, action_id, template_arg, args):
     return var
 
 
+FEED_ACTION_SCHEMA = cv.maybe_simple_value(
+    DOOR_ACTION_SCHEMA.extend(
+        {
+            cv.Optional(CONF_PORTIONS, default=0x01): cv.templatable(
+                cv.int_range(min=0, max=255)
+            ),
+            cv.Optional(CONF_BEEP, default=False): cv.boolean,
+        }
+    ),
+    key=CONF_PORTIONS,
+)
+
+
+@automation.register_action("pkt_p530.feed", FeedAction, FEED_ACTION_SCHEMA)
+async def pkt_p530_feed_to_code(config, action_id, template_arg, args):
+    var = await base_action_code(config, action_id, template_arg, args)
+
+    template_ = await cg.templatable(config[CONF_PORTIONS], args, cg.uint8)
+    cg.add(var.set_portions(template_))
+    cg.add(var.set_duration(config[CONF_DURATION]))
+    cg.add(var.set_door_timeout(config[CONF_TIMEOUT]))
+    cg.add(var.set_beep(config[CONF_BEEP]))
+    return var
+
+
 # ============== Misc Actions ==============
 
 
@@ -3,6 +3,7 @@
 #include "p530_component.h"
 #include "protocol.h"
 
+#include <esphome/core/hal.h>
 #include <esphome/core/log.h>
 #include <esphome/core/component.h>
 #include <esphome/core/base_automation.h>
@@ -11,11 +12,16 @@
 namespace esphome {
 namespace pkt_p530 {
 
+// 1 portion about 1.65s, the timeout only grows beyond this when measured dispenses take longer
+static const uint32_t DISPENSE_MS_PER_PORTION = 3000;
+
 // ============== Base Action ==============
 
 template<typename... Ts> class PktAction : public Action<Ts...>, public Parented<P530Component> {
  public:
   void set_wait_for_complete(bool v) { this->wait_for_complete_ = v; }
+  // 0 waits for the ACK until the component gives up retransmitting the request, an explicit timeout also ends the
+  // retransmissions
   void set_send_timeout(uint32_t ms) { this->send_timeout_ms_ = ms; }
 
   void add_on_complete(std::initializer_list<Action<Ts...> *> actions) {
@@ -32,6 +38,7 @@ template<typename... Ts> class PktAction : public Action<Ts...>, public Parented
     this->num_running_++;
     this->args_ = std::make_tuple(x...);
     this->stage_ = Stage::IDLE;
+    this->run_++;
 
     ErrorCode e = this->do_action_(x...);
     if (e != ErrorCode::OK) {
@@ -46,7 +53,10 @@ template<typename... Ts> class PktAction : public Action<Ts...>, public Parented
 
   void play(const Ts &...) override {}  // not used, see play_complex
 
+  // The request stays with the MCU, but its replies no longer finish the action
   void stop() override {
+    this->stage_ = Stage::FINISHED;
+    this->run_++;
     this->on_complete_.stop();
     this->on_error_.stop();
   }
@@ -82,14 +92,18 @@ template<typename... Ts> class PktAction : public Action<Ts...>, public Parented
     return ErrorCode::OK;
   }
 
+  uint32_t ack_timeout_() const { return this->send_timeout_ms_ > 0 ? this->send_timeout_ms_ : ACK_WAIT_LIMIT_MS; }
+
+  // wait_timeout_ms is the minimum wait, extended when the measured report time (scaled by units) is longer
   ErrorCode send_cmd_(ReqType req, const uint8_t *payload, uint8_t len, ReportType wait_rtype = ReportType::NONE,
-                      uint32_t wait_timeout_ms = 0) {
+                      uint32_t wait_timeout_ms = 0, uint8_t units = 1) {
     uint8_t seq = this->parent_->send(req, payload, len);
     if (seq == MAX_SEQ)
       return ErrorCode::SEND_FAILED;
 
     this->stage_ = Stage::WAIT_ACK;
     this->expected_report_timeout_ = wait_timeout_ms;
+    this->expected_report_units_ = units;
     this->expected_report_seq_ = seq;
     this->expected_report_type_ = 0;
     if (wait_rtype != ReportType::NONE) {
@@ -97,14 +111,27 @@ template<typename... Ts> class PktAction : public Action<Ts...>, public Parented
     }
 
     uint8_t req_type = static_cast<uint8_t>(req);
-    this->parent_->add_report_waiter(
-        req_type, seq, this->send_timeout_ms_,
-        std::bind(&PktAction::on_packet_, this, std::placeholders::_1, std::placeholders::_2));
+    if (!this->parent_->add_report_waiter(req_type, seq, this->ack_timeout_(), this->packet_callback_())) {
+      return ErrorCode::SEND_FAILED;
+    }
 
     return ErrorCode::OK;
   }
 
-  bool on_packet_(ErrorCode err, const std::span<const uint8_t> payload) {
+  // Capturing only this and the run keeps the callback within std::function's small buffer, so waiting allocates
+  // nothing
+  ReportCallback packet_callback_() {
+    return [this, run = this->run_](ErrorCode err, const std::span<const uint8_t> payload) {
+      return this->on_packet_(run, err, payload);
+    };
+  }
+
+  bool on_packet_(uint32_t run, ErrorCode err, const std::span<const uint8_t> payload) {
+    if (run != this->run_) {
+      // left over from a stopped or previous run
+      return true;
+    }
+
     switch (this->stage_) {
       case Stage::WAIT_ACK:
         if (err != ErrorCode::OK) {
@@ -124,9 +151,14 @@ template<typename... Ts> class PktAction : public Action<Ts...>, public Parented
 
         // Need to wait for a report
         this->stage_ = Stage::WAIT_REPORT;
-        this->parent_->add_report_waiter(
-            this->expected_report_type_, this->expected_report_seq_, this->expected_report_timeout_,
-            std::bind(&PktAction::on_packet_, this, std::placeholders::_1, std::placeholders::_2));
+        this->ack_ms_ = millis();
+        if (!this->parent_->add_report_waiter(
+                this->expected_report_type_, this->expected_report_seq_,
+                this->parent_->get_completion_timeout(static_cast<ReportType>(this->expected_report_type_),
+                                                      this->expected_report_units_, this->expected_report_timeout_),
+                this->packet_callback_())) {
+          this->finish_(ErrorCode::SEND_FAILED);
+        }
         return true;
 
       case Stage::WAIT_REPORT:
@@ -141,6 +173,11 @@ template<typename... Ts> class PktAction : public Action<Ts...>, public Parented
           return false;
         }
 
+        if (err == ErrorCode::OK) {
+          this->parent_->add_completion_sample(static_cast<ReportType>(this->expected_report_type_),
+                                               this->expected_report_units_, millis() - this->ack_ms_);
+        }
+
         this->finish_(err);
         return true;
 
@@ -183,13 +220,17 @@ template<typename... Ts> class PktAction : public Action<Ts...>, public Parented
 
  protected:
   Stage stage_{Stage::IDLE};
+  // replies to a stopped or previous run are ignored
+  uint32_t run_{0};
 
   uint8_t expected_report_type_{0};
   uint8_t expected_report_seq_{0};
+  uint8_t expected_report_units_{1};
   uint32_t expected_report_timeout_{0};
+  uint32_t ack_ms_{0};
 
   std::tuple<Ts...> args_;
-  uint32_t send_timeout_ms_{1000};
+  uint32_t send_timeout_ms_{0};
   bool wait_for_complete_{true};
 
   ActionList<Ts...> on_complete_;
@@ -235,12 +276,7 @@ template<ReqType req, ReportType report, typename... Ts> class DoorCtlAction : p
     return this->send_cmd_(req, &this->duration_, sizeof(uint8_t), report, this->timeout_ms_);
   }
 
-  ErrorCode handle_report_(const std::span<const uint8_t> payload) override {
-    if (payload.empty()) {
-      return ErrorCode::NOT_IMPLEMENTED;  // not our packet
-    }
-    return payload[0] == 0x02 ? ErrorCode::OK : ErrorCode::DOOR_BLOCKED;
-  }
+  ErrorCode handle_report_(const std::span<const uint8_t> payload) override { return check_door_report(payload); }
 
  private:
   uint8_t duration_{0x1E};
@@ -261,18 +297,64 @@ template<typename... Ts> class DispenseAction : public PktAction<Ts...> {
     uint8_t portions = this->portions_.value(x...);
     uint8_t payload[] = {portions, 0x01, 0x01, 0x50};
 
-    // 1 portion about 1.65s
-    uint32_t timeout = portions * 3000;
-    return this->send_cmd_(ReqType::DISPENSE, payload, sizeof(payload), ReportType::DISPENSE_DONE, timeout);
+    uint32_t timeout = portions * DISPENSE_MS_PER_PORTION;
+    return this->send_cmd_(ReqType::DISPENSE, payload, sizeof(payload), ReportType::DISPENSE_DONE, timeout, portions);
   }
 
-  ErrorCode handle_report_(const std::span<const uint8_t> payload) override {
-    if (payload.size() < 3 || payload[2] == 0x00) {
-      return ErrorCode::NOT_IMPLEMENTED;  // not done yet
+  ErrorCode handle_report_(const std::span<const uint8_t> payload) override { return check_dispense_report(payload); }
+};
+
+// ============== Feed Action ==============
+
+// Opens the door, dispenses and closes the door again as one transaction. The optional beep goes out alongside the
+// door motion, the door is closed even if dispensing failed.
+template<typename... Ts> class FeedAction : public PktAction<Ts...> {
+ public:
+  TEMPLATABLE_VALUE(uint8_t, portions)
+  void set_duration(uint8_t v) { this->duration_ = v; }
+  void set_door_timeout(uint32_t ms) { this->door_timeout_ms_ = ms; }
+  void set_beep(bool v) { this->beep_ = v; }
+
+  // The door is still closed if it was opened already
+  void stop() override {
+    PktAction<Ts...>::stop();
+    this->transaction_.cancel();
+  }
+
+ protected:
+  ErrorCode do_action_(const Ts &...x) override {
+    static const uint8_t BEEP[] = {static_cast<uint8_t>(LedCtlTarget::BEEP), 0x00, 0xC8, 0x00, 0x00, 0x00, 0x01};
+    uint8_t portions = this->portions_.value(x...);
+    uint8_t dispense[] = {portions, 0x01, 0x01, 0x50};
+
+    Transaction &t = this->transaction_;
+    if (t.is_running()) {
+      return ErrorCode::SEND_FAILED;
     }
 
+    t.clear();
+    int8_t open = t.add_step(ReqType::OPEN_DOOR, &this->duration_, sizeof(uint8_t), 0, ReportType::DOOR_OPEN_DONE,
+                             this->door_timeout_ms_, check_door_report);
+    int8_t dispensed = t.add_step(ReqType::DISPENSE, dispense, sizeof(dispense), 1 << open, ReportType::DISPENSE_DONE,
+                                  portions * DISPENSE_MS_PER_PORTION, check_dispense_report, false, portions);
+    t.add_step(ReqType::CLOSE_DOOR, &this->duration_, sizeof(uint8_t), 1 << dispensed, ReportType::DOOR_CLOSE_DONE,
+               this->door_timeout_ms_, check_door_report, true);
+    if (this->beep_) {
+      t.add_step(ReqType::LED_CTL, BEEP, sizeof(BEEP));
+    }
+
+    this->stage_ = PktAction<Ts...>::Stage::WAIT_REPORT;
+    if (!this->parent_->run_transaction(t, this->ack_timeout_(), [this](ErrorCode err) { this->finish_(err); })) {
+      return ErrorCode::SEND_FAILED;
+    }
     return ErrorCode::OK;
   }
+
+ private:
+  Transaction transaction_;
+  uint8_t duration_{0x1E};
+  uint32_t door_timeout_ms_{10000};
+  bool beep_{false};
 };
 
 // ============== Init Action ==============
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace esphome {
+namespace pkt_p530 {
+
+// CRC-16/CCITT-FALSE (poly 0x1021, not reflected) protecting every packet, the same as crc16be() with an initial
+// value of 0xFFFF. It is updated as bytes are received or written, so packets need no second pass.
+static const uint16_t CRC16_INIT = 0xFFFF;
+
+uint16_t crc16_update(uint16_t crc, uint8_t byte);
+uint16_t crc16_update(uint16_t crc, const uint8_t *data, size_t len);
+
+}  // namespace pkt_p530
+}  // namespace esphome
@@ -3,6 +3,9 @@
 #include <esphome/core/log.h>
 #include <esphome/core/helpers.h>
 
+#include <algorithm>
+#include <cstring>
+
 namespace esphome {
 namespace pkt_p530 {
 
@@ -18,85 +21,297 @@ void P530Component::dump_config() {
   LOG_BINARY_SENSOR("  ", "Door Close Issue Sensor", this->door_close_issue_sensor_);
   LOG_BINARY_SENSOR("  ", "Low Food Issue Sensor", this->food_low_issue_sensor_);
   LOG_SENSOR("  ", "Dispensed Food Portions Sensor", this->dispensed_portions_sensor_);
+  ESP_LOGCONFIG(TAG, "  Max In Flight: %u", this->max_in_flight_);
+  ESP_LOGCONFIG(TAG, "  Max Retries: %u", this->max_retries_);
+  LOG_SENSOR("  ", "TX Queue Depth Sensor", this->tx_queue_depth_sensor_);
+  LOG_SENSOR("  ", "TX Latency Sensor", this->tx_latency_sensor_);
+  LOG_SENSOR("  ", "Framing Errors Sensor", this->framing_errors_sensor_);
+  LOG_SENSOR("  ", "CRC Errors Sensor", this->crc_errors_sensor_);
+  LOG_SENSOR("  ", "Resync Bytes Sensor", this->resync_bytes_sensor_);
+  LOG_SENSOR("  ", "TX Retries Sensor", this->tx_retries_sensor_);
+  LOG_SENSOR("  ", "TX Failures Sensor", this->tx_failures_sensor_);
+  LOG_SENSOR("  ", "TX Latency P50 Sensor", this->tx_latency_p50_sensor_);
+  LOG_SENSOR("  ", "TX Latency P95 Sensor", this->tx_latency_p95_sensor_);
 }
 
 void P530Component::loop() {
   this->check_waiter_timeouts_();
+  this->check_in_flight_timeouts_();
   while (this->read_packet_()) {
   }
+  this->publish_rx_stats_();
+  this->process_tx_queue_();
 }
 
-void P530Component::check_waiter_timeouts_() {
-  if (this->waiters_.empty()) {
+void P530Component::process_tx_queue_() {
+  bool sent = false;
+  while (this->tx_count_ > 0 && this->in_flight_count_ < this->max_in_flight_) {
+    const TxSlot &slot = this->tx_queue_[this->tx_head_];
+    if (!this->tx_fits_(slot.len)) {
+      // stays queued until the FIFO drained
+      break;
+    }
+
+    uint32_t now = millis();
+    uint8_t type = slot.data[3];
+    uint16_t rto = this->ack_rtt_[type % NUM_TIMING_TYPES].timeout(INITIAL_ACK_RTO_MS, MIN_ACK_RTO_MS, MAX_ACK_RTO_MS);
+    this->in_flight_[this->in_flight_count_++] = {slot, now, rto, 0};
+
+    ESP_LOGD(TAG, "TX: type=0x%02X seq=0x%02X len=%u queued=%ums rto=%ums", type, slot.data[4],
+             slot.len - PACKET_MIN_SIZE, now - slot.queued_ms, rto);
+    this->write_packet_(slot.data, slot.len);
+
+    this->tx_head_ = (this->tx_head_ + 1) % TX_QUEUE_SIZE;
+    this->tx_count_--;
+    sent = true;
+  }
+
+  if (sent) {
+    this->publish_tx_queue_depth_();
+  }
+}
+
+uint32_t P530Component::tx_us_per_byte_() const {
+  // start, 8 data and stop bit
+  const uint32_t baud = this->parent_->get_baud_rate();
+  return baud > 0 ? 10000000 / baud : 0;
+}
+
+bool P530Component::tx_fits_(uint8_t len) const {
+  const int32_t pending_us = static_cast<int32_t>(this->tx_drained_us_ - micros());
+  const uint32_t us_per_byte = this->tx_us_per_byte_();
+  if (pending_us <= 0 || us_per_byte == 0) {
+    return true;
+  }
+
+  const uint32_t pending = (pending_us + us_per_byte - 1) / us_per_byte;
+  return pending + len <= UART_TX_FIFO_SIZE;
+}
+
+void P530Component::write_packet_(const uint8_t *data, uint8_t len) {
+  this->write_array(data, len);
+
+  const uint32_t now = micros();
+  if (static_cast<int32_t>(this->tx_drained_us_ - now) < 0) {
+    this->tx_drained_us_ = now;
+  }
+  this->tx_drained_us_ += len * this->tx_us_per_byte_();
+}
+
+void P530Component::release_in_flight_(uint8_t type, uint8_t seq) {
+  for (uint8_t i = 0; i < this->in_flight_count_; i++) {
+    InFlightRequest &req = this->in_flight_[i];
+    if (req.type() != type || req.seq() != seq) {
+      continue;
+    }
+
+    uint32_t now = millis();
+    // a reply to a retransmitted request may answer any of its copies, so only first attempts are timed (Karn)
+    if (req.retries == 0) {
+      this->ack_rtt_[type % NUM_TIMING_TYPES].sample(now - req.sent_ms);
+    }
+
+    uint32_t latency = now - req.packet.queued_ms;
+    ESP_LOGV(TAG, "Request answered: type=0x%02X seq=0x%02X latency=%ums retries=%u", type, seq, latency,
+             req.retries);
+    this->publish_tx_latency_(latency);
+
+    req = this->in_flight_[--this->in_flight_count_];
     return;
   }
+}
 
+void P530Component::check_in_flight_timeouts_() {
   uint32_t now = millis();
-  std::vector<ReportCallback> expired;
+  for (uint8_t i = 0; i < this->in_flight_count_;) {
+    InFlightRequest &req = this->in_flight_[i];
+    if (now - req.sent_ms < req.rto_ms) {
+      ++i;
+      continue;
+    }
+
+    uint8_t type = req.type();
+    uint8_t seq = req.seq();
+    if (req.retries < this->max_retries_ && is_retransmittable_(type)) {
+      if (!this->tx_fits_(req.packet.len)) {
+        // retried in the next loop, once the FIFO drained
+        ++i;
+        continue;
+      }
 
-  for (auto it = this->waiters_.begin(); it != this->waiters_.end();) {
-    if (it->deadline_ms != 0 && static_cast<int32_t>(now - it->deadline_ms) >= 0) {
-      ESP_LOGD(TAG, "Waiter timeout: type=0x%02X seq=0x%02X", it->type, it->seq);
-      expired.push_back(std::move(it->callback));
-      it = this->waiters_.erase(it);
+      // same seq, so the MCU and the waiters see the same request
+      req.retries++;
+      req.sent_ms = now;
+      req.rto_ms = std::min<uint32_t>(req.rto_ms * 2, MAX_ACK_RTO_MS);
+      ESP_LOGD(TAG, "Retransmit request: type=0x%02X seq=0x%02X retry=%u rto=%ums", type, seq, req.retries,
+               req.rto_ms);
+      this->write_packet_(req.packet.data, req.packet.len);
+
+      this->tx_retries_++;
+      if (this->tx_retries_sensor_ != nullptr) {
+        this->tx_retries_sensor_->publish_state(this->tx_retries_);
+      }
+      ++i;
       continue;
     }
 
-    ++it;
+    ESP_LOGW(TAG, "No reply to request: type=0x%02X seq=0x%02X retries=%u", type, seq, req.retries);
+    req = this->in_flight_[--this->in_flight_count_];
+    this->tx_failures_++;
+    if (this->tx_failures_sensor_ != nullptr) {
+      this->tx_failures_sensor_->publish_state(this->tx_failures_);
+    }
+    this->waiters_.fail(type, seq, ErrorCode::TIMEOUT);
+  }
+}
+
+void P530Component::cancel_in_flight_(uint8_t type, uint8_t seq) {
+  for (uint8_t i = 0; i < this->in_flight_count_; i++) {
+    InFlightRequest &req = this->in_flight_[i];
+    if (req.type() != type || req.seq() != seq) {
+      continue;
+    }
+
+    ESP_LOGW(TAG, "Waiter gave up on request: type=0x%02X seq=0x%02X retries=%u", type, seq, req.retries);
+    req = this->in_flight_[--this->in_flight_count_];
+    this->tx_failures_++;
+    if (this->tx_failures_sensor_ != nullptr) {
+      this->tx_failures_sensor_->publish_state(this->tx_failures_);
+    }
+    return;
+  }
+}
+
+void P530Component::publish_tx_latency_(uint32_t latency) {
+  if (this->tx_latency_sensor_ != nullptr) {
+    this->tx_latency_sensor_->publish_state(latency);
+  }
+
+  this->latency_histogram_.add(latency);
+  // percentiles are bucket bounds, so they only change now and then
+  uint32_t p50 = this->latency_histogram_.percentile(50);
+  if (this->tx_latency_p50_sensor_ != nullptr &&
+      (!this->tx_latency_p50_sensor_->has_state() || this->tx_latency_p50_sensor_->state != p50)) {
+    this->tx_latency_p50_sensor_->publish_state(p50);
+  }
+
+  uint32_t p95 = this->latency_histogram_.percentile(95);
+  if (this->tx_latency_p95_sensor_ != nullptr &&
+      (!this->tx_latency_p95_sensor_->has_state() || this->tx_latency_p95_sensor_->state != p95)) {
+    this->tx_latency_p95_sensor_->publish_state(p95);
+  }
+  this->latency_histogram_.log(TAG);
+}
+
+uint32_t P530Component::get_completion_timeout(ReportType report, uint8_t units, uint32_t min_timeout_ms) const {
+  const RtoEstimator &estimator = this->completion_time_[static_cast<uint8_t>(report) % NUM_TIMING_TYPES];
+  if (!estimator.has_samples()) {
+    return min_timeout_ms;
+  }
+
+  const uint32_t measured =
+      std::max<uint8_t>(units, 1) * estimator.timeout(0, MIN_COMPLETION_TIMEOUT_MS, MAX_COMPLETION_TIMEOUT_MS);
+  return std::max(min_timeout_ms, measured);
+}
+
+void P530Component::add_completion_sample(ReportType report, uint8_t units, uint32_t ms) {
+  RtoEstimator &estimator = this->completion_time_[static_cast<uint8_t>(report) % NUM_TIMING_TYPES];
+  estimator.sample(ms / std::max<uint8_t>(units, 1));
+  ESP_LOGD(TAG, "Completion time: type=0x%02X took=%ums units=%u srtt=%ums timeout=%ums",
+           static_cast<uint8_t>(report), ms, units, estimator.get_srtt(),
+           estimator.timeout(0, MIN_COMPLETION_TIMEOUT_MS, MAX_COMPLETION_TIMEOUT_MS));
+}
+
+void P530Component::publish_tx_queue_depth_() {
+  if (this->tx_queue_depth_sensor_ == nullptr) {
+    return;
+  }
+
+  if (this->tx_queue_depth_sensor_->has_state() && this->tx_queue_depth_sensor_->state == this->tx_count_) {
+    return;
   }
 
-  for (auto &cb : expired) {
-    cb(ErrorCode::TIMEOUT, {});
+  this->tx_queue_depth_sensor_->publish_state(this->tx_count_);
+}
+
+void P530Component::check_waiter_timeouts_() {
+  if (this->waiters_.empty()) {
+    return;
   }
+
+  // ACK waiters use the request type, report waiters match no in-flight request
+  this->waiters_.expire(millis(), [this](uint8_t type, uint8_t seq) { this->cancel_in_flight_(type, seq); });
 }
 
-void P530Component::add_report_waiter(uint8_t type, uint8_t seq, uint32_t timeout_ms, ReportCallback callback) {
+bool P530Component::add_report_waiter(uint8_t type, uint8_t seq, uint32_t timeout_ms, ReportCallback callback) {
   uint32_t deadline = 0;
   if (timeout_ms > 0) {
-    deadline = millis() + timeout_ms;
+    // 0 means no deadline
+    deadline = std::max<uint32_t>(millis() + timeout_ms, 1);
   }
 
   ESP_LOGD(TAG, "Add waiter: type=0x%02X seq=0x%02X timeout=%ums", type, seq, timeout_ms);
-  this->waiters_.push_back({type, seq, deadline, std::move(callback)});
+  return this->waiters_.add(type, seq, deadline, std::move(callback));
 }
 
 bool P530Component::read_packet_() {
-  if (this->available() < PACKET_MIN_SIZE) {
-    return false;
+  int available = this->available();
+  uint8_t space = sizeof(this->rx_buffer_) - this->rx_len_;
+  if (available > 0 && space > 0) {
+    uint8_t count = std::min<int>(available, space);
+    if (this->read_array(&this->rx_buffer_[this->rx_len_], count)) {
+      this->rx_len_ += count;
+      this->rx_last_ms_ = millis();
+    }
   }
-
-  uint8_t b;
-  while (this->available() >= PACKET_MIN_SIZE) {
-    if (!this->read_byte(&b) || b != 0xAA) {
-      ESP_LOGW(TAG, "Unpexpected first byte in packet: 0x%02X != 0xAA", b);
+  // nothing arrived for a while, packets that are not complete yet never will be
+  bool stale = available <= 0 && millis() - this->rx_last_ms_ > RX_FRAME_TIMEOUT_MS;
+
+  while (this->rx_len_ > 0) {
+    if (this->rx_buffer_[0] != 0xAA || (this->rx_len_ > 1 && this->rx_buffer_[1] != 0xAA)) {
+      ESP_LOGW(TAG, "Unexpected bytes before packet start: 0x%02X", this->rx_buffer_[0]);
+      this->framing_errors_++;
+      this->drop_rx_bytes_(this->find_frame_start_(), true);
       continue;
     }
 
-    if (!this->read_byte(&b) || b != 0xAA) {
-      ESP_LOGW(TAG, "Unpexpected first byte in packet: 0x%02X != 0xAA", b);
-      continue;
+    if (this->rx_len_ < 3) {
+      return false;
     }
 
-    uint8_t len;
-    if (!this->read_byte(&len) || len < PACKET_MIN_SIZE || len > PACKET_MAX_SIZE) {
+    uint8_t len = this->rx_buffer_[2];
+    if (len < PACKET_MIN_SIZE) {
       ESP_LOGE(TAG, "Invalid packet len: %d", len);
+      this->framing_errors_++;
+      this->drop_rx_bytes_(this->find_frame_start_(), true);
       continue;
     }
 
-    this->rx_buffer_[0] = 0xAA;
-    this->rx_buffer_[1] = 0xAA;
-    this->rx_buffer_[2] = len;
+    // continue the CRC where the previous call stopped, it covers everything but the CRC itself
+    uint8_t crc_end = std::min<uint8_t>(this->rx_len_, len - PACKET_CRC_SIZE);
+    if (this->rx_crc_len_ < crc_end) {
+      this->rx_crc_ = crc16_update(this->rx_crc_, &this->rx_buffer_[this->rx_crc_len_], crc_end - this->rx_crc_len_);
+      this->rx_crc_len_ = crc_end;
+    }
 
-    if (!this->read_array(&this->rx_buffer_[3], len - 3)) {
-      ESP_LOGE(TAG, "Unable to read %d bytes", len - 3);
-      return false;
+    if (this->rx_len_ < len) {
+      if (!stale) {
+        // rest of the packet has not arrived yet
+        return false;
+      }
+
+      ESP_LOGW(TAG, "Incomplete packet, %u of %u bytes", this->rx_len_, len);
+      this->framing_errors_++;
+      this->drop_rx_bytes_(this->find_frame_start_(), true);
+      continue;
     }
 
     uint16_t rx_crc = (this->rx_buffer_[len - 2] << 8) | this->rx_buffer_[len - 1];
-    uint16_t calc_crc = crc16be(this->rx_buffer_, len - PACKET_CRC_SIZE, 0xFFFF);
-
-    if (rx_crc != calc_crc) {
+    if (rx_crc != this->rx_crc_) {
+      // the packet start may have been a false match, rescan what was received after it
       ESP_LOGE(TAG, "CRC mismatch");
+      this->crc_errors_++;
+      this->drop_rx_bytes_(this->find_frame_start_(), true);
       continue;
     }
 
@@ -107,13 +322,58 @@ bool P530Component::read_packet_() {
 
     ESP_LOGD(TAG, "RX: type=0x%02X seq=0x%02X len=%u", type, seq, payload_len);
     this->handle_packet_(type, seq, payload);
+    this->drop_rx_bytes_(len, false);
     return true;
   }
 
   return false;
 }
 
+uint8_t P530Component::find_frame_start_() const {
+  for (uint8_t i = 1; i < this->rx_len_; i++) {
+    if (this->rx_buffer_[i] == 0xAA && (i + 1 == this->rx_len_ || this->rx_buffer_[i + 1] == 0xAA)) {
+      return i;
+    }
+  }
+
+  return this->rx_len_;
+}
+
+void P530Component::drop_rx_bytes_(uint8_t count, bool resync) {
+  this->rx_len_ -= count;
+  memmove(this->rx_buffer_, &this->rx_buffer_[count], this->rx_len_);
+  this->rx_crc_ = CRC16_INIT;
+  this->rx_crc_len_ = 0;
+
+  if (resync) {
+    this->resync_bytes_ += count;
+    this->rx_stats_changed_ = true;
+  }
+}
+
+void P530Component::publish_rx_stats_() {
+  if (!this->rx_stats_changed_) {
+    return;
+  }
+
+  this->rx_stats_changed_ = false;
+  if (this->framing_errors_sensor_ != nullptr) {
+    this->framing_errors_sensor_->publish_state(this->framing_errors_);
+  }
+
+  if (this->crc_errors_sensor_ != nullptr) {
+    this->crc_errors_sensor_->publish_state(this->crc_errors_);
+  }
+
+  if (this->resync_bytes_sensor_ != nullptr) {
+    this->resync_bytes_sensor_->publish_state(this->resync_bytes_);
+  }
+}
+
 void P530Component::handle_packet_(uint8_t type, uint8_t seq, const std::span<const uint8_t> payload) {
+  // replies carry the type and seq of the request
+  this->release_in_flight_(type, seq);
+
   // Check interesting reports
   switch (static_cast<ReportType>(type)) {
     case ReportType::STATUS:
@@ -137,36 +397,7 @@ void P530Component::handle_packet_(uint8_t type, uint8_t seq, const std::span<co
       break;
   }
 
-  if (this->waiters_.empty()) {
-    return;
-  }
-
-  std::vector<ReportWaiter> matched;
-  for (auto it = this->waiters_.begin(); it != this->waiters_.end();) {
-    if (it->type != type) {
-      ++it;
-      continue;
-    }
-
-    if (it->seq != 0 && it->seq != seq) {
-      ++it;
-      continue;
-    }
-
-    matched.push_back(std::move(*it));
-    it = this->waiters_.erase(it);
-  }
-
-  for (auto &waiter : matched) {
-    if (!waiter.callback(ErrorCode::OK, payload)) {
-      // Callback rejected the payload, re-register the waiter
-      ESP_LOGV(TAG, "Waiter rejected packet, re-registering: type=0x%02X seq=0x%02X", waiter.type, waiter.seq);
-      this->waiters_.push_back(std::move(waiter));
-      continue;
-    }
-
-    ESP_LOGD(TAG, "Waiter matched: type=0x%02X seq=0x%02X", waiter.type, waiter.seq);
-  }
+  this->waiters_.dispatch(type, seq, payload);
 }
 
 void P530Component::handle_status_(const std::span<const uint8_t> payload) {
@@ -242,13 +473,25 @@ void P530Component::handle_dispense_complete_(const std::span<const uint8_t> pay
 }
 
 uint8_t P530Component::send(ReqType req, const uint8_t *payload, uint8_t len) {
-  if (this->tx_seq_ < MAX_SEQ) {
+  if (len > TX_SLOT_SIZE - PACKET_MIN_SIZE) {
+    ESP_LOGE(TAG, "Request too long: type=0x%02X len=%u", static_cast<uint8_t>(req), len);
+    return MAX_SEQ;
+  }
+
+  if (this->tx_count_ >= TX_QUEUE_SIZE) {
+    ESP_LOGW(TAG, "TX queue full, dropping request: type=0x%02X", static_cast<uint8_t>(req));
+    return MAX_SEQ;
+  }
+
+  if (this->tx_seq_ < MAX_SEQ - 1) {
     this->tx_seq_++;
   } else {
     this->tx_seq_ = 1;
   }
 
-  uint8_t pkt[PACKET_MAX_SIZE];
+  // the packet is built right in its queue slot
+  TxSlot &slot = this->tx_queue_[(this->tx_head_ + this->tx_count_) % TX_QUEUE_SIZE];
+  uint8_t *pkt = slot.data;
   uint8_t pkt_len = PACKET_HEADER_SIZE + len + PACKET_CRC_SIZE;
 
   pkt[0] = 0xAA;
@@ -256,17 +499,24 @@ uint8_t P530Component::send(ReqType req, const uint8_t *payload, uint8_t len) {
   pkt[2] = pkt_len;
   pkt[3] = static_cast<uint8_t>(req);
   pkt[4] = this->tx_seq_;
+  uint16_t crc = crc16_update(CRC16_INIT, pkt, PACKET_HEADER_SIZE);
 
-  if (len > 0 && payload) {
-    memcpy(&pkt[PACKET_HEADER_SIZE], payload, len);
+  // the payload is covered by the CRC while it is copied
+  uint8_t *out = &pkt[PACKET_HEADER_SIZE];
+  for (uint8_t i = 0; i < len; i++) {
+    out[i] = payload != nullptr ? payload[i] : 0x00;
+    crc = crc16_update(crc, out[i]);
   }
 
-  uint16_t crc = crc16be(pkt, pkt_len - PACKET_CRC_SIZE, 0xFFFF);
   pkt[pkt_len - 2] = crc >> 8;
   pkt[pkt_len - 1] = crc & 0xFF;
 
-  ESP_LOGD(TAG, "TX: type=0x%02X seq=0x%02X len=%u", static_cast<uint8_t>(req), this->tx_seq_, len);
-  this->write_array(pkt, pkt_len);
+  slot.len = pkt_len;
+  slot.queued_ms = millis();
+  this->tx_count_++;
+
+  this->process_tx_queue_();
+  this->publish_tx_queue_depth_();
   return this->tx_seq_;
 }
 
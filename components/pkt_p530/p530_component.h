@@ -1,6 +1,10 @@
 #pragma once
 
+#include "crc16.h"
 #include "protocol.h"
+#include "timing.h"
+#include "transaction.h"
+#include "waiter_table.h"
 
 #include <esphome/core/component.h>
 #include <esphome/core/automation.h>
@@ -32,13 +36,44 @@ enum class DoorDirection : uint8_t {
   CLOSE = 2,
 };
 
-using ReportCallback = std::function<bool(ErrorCode, const std::span<const uint8_t> payload)>;
+// Packets queued for transmission. The largest request is 19 bytes, so slots are sized well below
+// PACKET_MAX_SIZE to keep the queue small on the ESP8266.
+static const uint8_t TX_QUEUE_SIZE = 8;
+static const uint8_t TX_SLOT_SIZE = 32;
+static const uint8_t MAX_IN_FLIGHT_LIMIT = 8;
+// Hardware TX FIFO of the ESP8266 UART. A write larger than the free space blocks until the bytes went out, so
+// packets are only written once the estimated fill level leaves room for them.
+static const uint8_t UART_TX_FIFO_SIZE = 128;
+// A partial packet without new bytes for this long is rescanned for the next packet start, a full packet takes
+// 22 ms at 115200 baud
+static const uint32_t RX_FRAME_TIMEOUT_MS = 50;
+// Retransmission timeout of a request before its ACK time was measured, and the limits for the measured one
+static const uint32_t INITIAL_ACK_RTO_MS = 1000;
+static const uint32_t MIN_ACK_RTO_MS = 100;
+static const uint32_t MAX_ACK_RTO_MS = 4000;
+// Limits for the time from the ACK to the report completing a request, per unit (e.g. portion)
+static const uint32_t MIN_COMPLETION_TIMEOUT_MS = 1000;
+static const uint32_t MAX_COMPLETION_TIMEOUT_MS = 60000;
+// Waiting for an ACK without an explicit timeout, requests normally fail earlier once retransmissions are exhausted
+static const uint32_t ACK_WAIT_LIMIT_MS = 30000;
+// Timing is tracked per request and report type, all types are below this
+static const uint8_t NUM_TIMING_TYPES = 0x15;
+
+struct TxSlot {
+  uint8_t data[TX_SLOT_SIZE];
+  uint8_t len;
+  uint32_t queued_ms;
+};
+
+// Request sent to the MCU and not answered yet, the packet is kept for retransmission
+struct InFlightRequest {
+  TxSlot packet;
+  uint32_t sent_ms;
+  uint16_t rto_ms;
+  uint8_t retries;
 
-struct ReportWaiter {
-  uint8_t type;
-  uint8_t seq;
-  uint32_t deadline_ms;
-  ReportCallback callback;
+  uint8_t type() const { return this->packet.data[3]; }
+  uint8_t seq() const { return this->packet.data[4]; }
 };
 
 class P530Component : public Component, public uart::UARTDevice {
@@ -62,6 +97,30 @@ class P530Component : public Component, public uart::UARTDevice {
 
   void set_dispensed_portions_sensor(sensor::Sensor *s) { this->dispensed_portions_sensor_ = s; }
 
+  void set_tx_queue_depth_sensor(sensor::Sensor *s) { this->tx_queue_depth_sensor_ = s; }
+
+  void set_tx_latency_sensor(sensor::Sensor *s) { this->tx_latency_sensor_ = s; }
+
+  void set_framing_errors_sensor(sensor::Sensor *s) { this->framing_errors_sensor_ = s; }
+
+  void set_crc_errors_sensor(sensor::Sensor *s) { this->crc_errors_sensor_ = s; }
+
+  void set_resync_bytes_sensor(sensor::Sensor *s) { this->resync_bytes_sensor_ = s; }
+
+  void set_tx_retries_sensor(sensor::Sensor *s) { this->tx_retries_sensor_ = s; }
+
+  void set_tx_failures_sensor(sensor::Sensor *s) { this->tx_failures_sensor_ = s; }
+
+  void set_tx_latency_p50_sensor(sensor::Sensor *s) { this->tx_latency_p50_sensor_ = s; }
+
+  void set_tx_latency_p95_sensor(sensor::Sensor *s) { this->tx_latency_p95_sensor_ = s; }
+
+  // Retransmissions of an unanswered request before it fails, DISPENSE is never retransmitted
+  void set_max_retries(uint8_t max_retries) { this->max_retries_ = max_retries; }
+
+  // Requests sent without a reply yet, further ones stay queued so bursts do not overflow the MCU's receive buffer
+  void set_max_in_flight(uint8_t max_in_flight) { this->max_in_flight_ = max_in_flight; }
+
   void add_on_error_callback(std::function<void(ErrorCode)> callback) {
     this->error_callback_.add(std::move(callback));
   }
@@ -74,16 +133,53 @@ class P530Component : public Component, public uart::UARTDevice {
     this->dispense_complete_callback_.add(std::move(callback));
   }
 
-  // Non-blocking send. Returns seq no
+  // Non-blocking send, the packet is queued and written from loop(). Returns seq no, MAX_SEQ if the queue is full
   uint8_t send(ReqType req, const uint8_t *payload, uint8_t len);
 
-  // Add a waiter for a report matching type and seq
-  void add_report_waiter(uint8_t type, uint8_t seq, uint32_t timeout_ms, ReportCallback callback);
+  // Add a waiter for a report matching type and seq, returns false if too many are waiting already
+  bool add_report_waiter(uint8_t type, uint8_t seq, uint32_t timeout_ms, ReportCallback callback);
+
+  // Timeout for the report completing a request, measured from its ACK. min_timeout_ms (the configured timeout) is
+  // only extended when the measured completion time, scaled by units (e.g. portions), is longer.
+  uint32_t get_completion_timeout(ReportType report, uint8_t units, uint32_t min_timeout_ms) const;
+  // Feed the time from the ACK to the report completing a request into the estimate
+  void add_completion_sample(ReportType report, uint8_t units, uint32_t ms);
+
+  // Send the steps of a transaction, pipelining the independent ones. on_complete is called once all steps
+  // finished, returns false if the transaction is still running.
+  bool run_transaction(Transaction &transaction, uint32_t ack_timeout_ms, Transaction::CompleteCallback on_complete) {
+    return transaction.start(this, ack_timeout_ms, std::move(on_complete));
+  }
 
  protected:
   void check_waiter_timeouts_();
 
+  // Write queued packets while fewer than max_in_flight_ requests are unanswered
+  void process_tx_queue_();
+  // Release the in-flight request answered by a packet of the given type and seq
+  void release_in_flight_(uint8_t type, uint8_t seq);
+  // Retransmit requests whose ACK is overdue, fail them once out of retries
+  void check_in_flight_timeouts_();
+  // Stop retransmitting a request whose ACK waiter timed out, the action already reported the failure
+  void cancel_in_flight_(uint8_t type, uint8_t seq);
+  // Whether a packet of len bytes fits into the TX FIFO without blocking, estimated from the bytes written and the
+  // baud rate since the UART API does not report the free space
+  bool tx_fits_(uint8_t len) const;
+  void write_packet_(const uint8_t *data, uint8_t len);
+  uint32_t tx_us_per_byte_() const;
+  void publish_tx_queue_depth_();
+  void publish_tx_latency_(uint32_t latency);
+  // Retransmitting a request the MCU already executed must not repeat its effect
+  static bool is_retransmittable_(uint8_t type) { return type != static_cast<uint8_t>(ReqType::DISPENSE); }
+
+  // Take in the available bytes and handle the first complete packet. A partial packet stays in rx_buffer_ until
+  // the next call. Returns true if a packet was handled.
   bool read_packet_();
+  // Offset of the next possible packet start after the first byte of rx_buffer_
+  uint8_t find_frame_start_() const;
+  // Remove bytes from the start of rx_buffer_, resync if they were not part of a valid packet
+  void drop_rx_bytes_(uint8_t count, bool resync);
+  void publish_rx_stats_();
   void handle_packet_(uint8_t type, uint8_t seq, const std::span<const uint8_t> payload);
   void handle_status_(const std::span<const uint8_t> payload);
   void handle_door_complete_(DoorDirection dir, const std::span<const uint8_t> payload);
@@ -91,11 +187,40 @@ class P530Component : public Component, public uart::UARTDevice {
 
   // State
   uint8_t rx_buffer_[PACKET_MAX_SIZE];
+  uint8_t rx_len_{0};
+  // CRC over the first rx_crc_len_ bytes of rx_buffer_
+  uint16_t rx_crc_{CRC16_INIT};
+  uint8_t rx_crc_len_{0};
+  uint32_t rx_last_ms_{0};
+
+  // RX statistics
+  uint32_t framing_errors_{0};
+  uint32_t crc_errors_{0};
+  uint32_t resync_bytes_{0};
+  bool rx_stats_changed_{false};
   uint8_t tx_seq_{0};
   StatusReport last_status_{};
 
+  // TX queue
+  TxSlot tx_queue_[TX_QUEUE_SIZE];
+  uint8_t tx_head_{0};
+  uint8_t tx_count_{0};
+  InFlightRequest in_flight_[MAX_IN_FLIGHT_LIMIT];
+  uint8_t in_flight_count_{0};
+  uint8_t max_in_flight_{2};
+  uint8_t max_retries_{2};
+  // micros() when the TX FIFO runs empty
+  uint32_t tx_drained_us_{0};
+
+  // Timing
+  RtoEstimator ack_rtt_[NUM_TIMING_TYPES];
+  RtoEstimator completion_time_[NUM_TIMING_TYPES];
+  LatencyHistogram latency_histogram_;
+  uint32_t tx_retries_{0};
+  uint32_t tx_failures_{0};
+
   // Report waiters
-  std::vector<ReportWaiter> waiters_;
+  WaiterTable waiters_;
 
   // Sensors
   binary_sensor::BinarySensor *door_opened_sensor_{nullptr};
@@ -103,6 +228,15 @@ class P530Component : public Component, public uart::UARTDevice {
   binary_sensor::BinarySensor *door_close_issue_sensor_{nullptr};
   binary_sensor::BinarySensor *door_open_issue_sensor_{nullptr};
   sensor::Sensor *dispensed_portions_sensor_{nullptr};
+  sensor::Sensor *tx_queue_depth_sensor_{nullptr};
+  sensor::Sensor *tx_latency_sensor_{nullptr};
+  sensor::Sensor *framing_errors_sensor_{nullptr};
+  sensor::Sensor *crc_errors_sensor_{nullptr};
+  sensor::Sensor *resync_bytes_sensor_{nullptr};
+  sensor::Sensor *tx_retries_sensor_{nullptr};
+  sensor::Sensor *tx_failures_sensor_{nullptr};
+  sensor::Sensor *tx_latency_p50_sensor_{nullptr};
+  sensor::Sensor *tx_latency_p95_sensor_{nullptr};
 
   // Callbacks
   CallbackManager<void(ErrorCode)> error_callback_;
@@ -1,12 +1,28 @@
 import esphome.codegen as cg
 from esphome.components import sensor
 import esphome.config_validation as cv
-from esphome.const import CONF_ID, ICON_COUNTER, STATE_CLASS_MEASUREMENT
+from esphome.const import (
+    CONF_ID,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    ICON_COUNTER,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+    UNIT_MILLISECOND,
+)
 
 from . import P530Component
 
+CONF_CRC_ERRORS = "crc_errors"
 CONF_DISPENSED_PORTIONS = "dispensed_portions"
+CONF_FRAMING_ERRORS = "framing_errors"
+CONF_RESYNC_BYTES = "resync_bytes"
 CONF_PORTIONS = "portions"
+CONF_TX_FAILURES = "tx_failures"
+CONF_TX_LATENCY = "tx_latency"
+CONF_TX_LATENCY_P50 = "tx_latency_p50"
+CONF_TX_LATENCY_P95 = "tx_latency_p95"
+CONF_TX_QUEUE_DEPTH = "tx_queue_depth"
+CONF_TX_RETRIES = "tx_retries"
 
 
 DEPENDENCIES = ["pkt_p530"]
@@ -20,6 +36,54 @@ CONFIG_SCHEMA = cv.Schema(
             accuracy_decimals=0,
             state_class=STATE_CLASS_MEASUREMENT,
         ),
+        cv.Optional(CONF_TX_QUEUE_DEPTH): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_TX_LATENCY): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_FRAMING_ERRORS): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_CRC_ERRORS): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_RESYNC_BYTES): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_TX_RETRIES): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_TX_FAILURES): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_TX_LATENCY_P50): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_TX_LATENCY_P95): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
     }
 )
 
@@ -30,3 +94,39 @@ async def to_code(config):
     if cfg := config.get(CONF_DISPENSED_PORTIONS):
         sens = await sensor.new_sensor(cfg)
         cg.add(parent.set_dispensed_portions_sensor(sens))
+
+    if cfg := config.get(CONF_TX_QUEUE_DEPTH):
+        sens = await sensor.new_sensor(cfg)
+        cg.add(parent.set_tx_queue_depth_sensor(sens))
+
+    if cfg := config.get(CONF_TX_LATENCY):
+        sens = await sensor.new_sensor(cfg)
+        cg.add(parent.set_tx_latency_sensor(sens))
+
+    if cfg := config.get(CONF_FRAMING_ERRORS):
+        sens = await sensor.new_sensor(cfg)
+        cg.add(parent.set_framing_errors_sensor(sens))
+
+    if cfg := config.get(CONF_CRC_ERRORS):
+        sens = await sensor.new_sensor(cfg)
+        cg.add(parent.set_crc_errors_sensor(sens))
+
+    if cfg := config.get(CONF_RESYNC_BYTES):
+        sens = await sensor.new_sensor(cfg)
+        cg.add(parent.set_resync_bytes_sensor(sens))
+
+    if cfg := config.get(CONF_TX_RETRIES):
+        sens = await sensor.new_sensor(cfg)
+        cg.add(parent.set_tx_retries_sensor(sens))
+
+    if cfg := config.get(CONF_TX_FAILURES):
+        sens = await sensor.new_sensor(cfg)
+        cg.add(parent.set_tx_failures_sensor(sens))
+
+    if cfg := config.get(CONF_TX_LATENCY_P50):
+        sens = await sensor.new_sensor(cfg)
+        cg.add(parent.set_tx_latency_p50_sensor(sens))
+
+    if cfg := config.get(CONF_TX_LATENCY_P95):
+        sens = await sensor.new_sensor(cfg)
+        cg.add(parent.set_tx_latency_p95_sensor(sens))
@@ -0,0 +1,78 @@
+#include "timing.h"
+
+#include <esphome/core/log.h>
+
+#include <algorithm>
+
+namespace esphome {
+namespace pkt_p530 {
+
+void RtoEstimator::sample(uint32_t ms) {
+  // 0 marks an estimator without samples
+  int32_t m = std::max<uint32_t>(ms, 1);
+  if (this->srtt_ == 0) {
+    this->srtt_ = m << 3;
+    this->rttvar_ = m << 1;
+    return;
+  }
+
+  m -= this->srtt_ >> 3;
+  this->srtt_ += m;
+  if (m < 0) {
+    m = -m;
+  }
+  m -= this->rttvar_ >> 2;
+  this->rttvar_ += m;
+}
+
+uint32_t RtoEstimator::timeout(uint32_t fallback_ms, uint32_t min_ms, uint32_t max_ms) const {
+  if (this->srtt_ == 0) {
+    return fallback_ms;
+  }
+
+  uint32_t rto = (this->srtt_ >> 3) + this->rttvar_;
+  return std::min(std::max(rto, min_ms), max_ms);
+}
+
+void LatencyHistogram::add(uint32_t ms) {
+  uint8_t bucket = 0;
+  while (bucket + 1 < HISTOGRAM_BUCKETS && ms >= (16u << bucket)) {
+    bucket++;
+  }
+
+  if (this->total_ >= HISTOGRAM_WINDOW) {
+    this->total_ = 0;
+    for (auto &count : this->counts_) {
+      count /= 2;
+      this->total_ += count;
+    }
+  }
+
+  this->counts_[bucket]++;
+  this->total_++;
+}
+
+uint32_t LatencyHistogram::percentile(uint8_t pct) const {
+  if (this->total_ == 0) {
+    return 0;
+  }
+
+  uint32_t rank = (uint32_t(this->total_) * pct + 99) / 100;
+  uint32_t seen = 0;
+  for (uint8_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+    seen += this->counts_[bucket];
+    if (seen >= rank) {
+      return 16u << bucket;
+    }
+  }
+  return 16u << (HISTOGRAM_BUCKETS - 1);
+}
+
+void LatencyHistogram::log(const char *tag) const {
+  ESP_LOGV(tag, "Latency histogram (<16 .. >=2048 ms): %u %u %u %u %u %u %u %u %u", this->counts_[0], this->counts_[1],
+           this->counts_[2], this->counts_[3], this->counts_[4], this->counts_[5], this->counts_[6], this->counts_[7],
+           this->counts_[8]);
+}
+
+}  // namespace pkt_p530
+}  // namespace esphome
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace esphome {
+namespace pkt_p530 {
+
+// Smoothed round trip time and its variation as in TCP (RFC 6298), the timeout is srtt + 4 * rttvar. Both are kept
+// in fixed point, srtt scaled by 8 and rttvar by 4, so the updates are shifts only.
+class RtoEstimator {
+ public:
+  void sample(uint32_t ms);
+
+  // Timeout clamped to [min_ms, max_ms], fallback_ms until the first sample
+  uint32_t timeout(uint32_t fallback_ms, uint32_t min_ms, uint32_t max_ms) const;
+
+  bool has_samples() const { return this->srtt_ != 0; }
+  uint32_t get_srtt() const { return this->srtt_ >> 3; }
+
+ protected:
+  int32_t srtt_{0};
+  int32_t rttvar_{0};
+};
+
+// Latency histogram with power of two buckets from < 16 ms to >= 2048 ms. Counts are halved once they add up to
+// HISTOGRAM_WINDOW, so percentiles follow recent behaviour.
+static const uint8_t HISTOGRAM_BUCKETS = 9;
+static const uint16_t HISTOGRAM_WINDOW = 256;
+
+class LatencyHistogram {
+ public:
+  void add(uint32_t ms);
+
+  // Upper bound of the bucket holding the given percentile, twice the lower bound for the last bucket. 0 if
+  // empty.
+  uint32_t percentile(uint8_t pct) const;
+
+  void log(const char *tag) const;
+
+ protected:
+  uint16_t counts_[HISTOGRAM_BUCKETS]{};
+  uint16_t total_{0};
+};
+
+}  // namespace pkt_p530
+}  // namespace esphome
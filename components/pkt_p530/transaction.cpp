@@ -0,0 +1,235 @@
+#include "transaction.h"
+#include "p530_component.h"
+
+#include <esphome/core/hal.h>
+#include <esphome/core/log.h>
+
+#include <cstring>
+
+namespace esphome {
+namespace pkt_p530 {
+
+namespace {
+static const char *const TAG = "pkt_p530.transaction";
+}  // namespace
+
+ErrorCode check_door_report(std::span<const uint8_t> payload) {
+  if (payload.empty()) {
+    return ErrorCode::NOT_IMPLEMENTED;  // not our packet
+  }
+  return payload[0] == 0x02 ? ErrorCode::OK : ErrorCode::DOOR_BLOCKED;
+}
+
+ErrorCode check_dispense_report(std::span<const uint8_t> payload) {
+  if (payload.size() < 3 || payload[2] == 0x00) {
+    return ErrorCode::NOT_IMPLEMENTED;  // not done yet
+  }
+  return ErrorCode::OK;
+}
+
+int8_t Transaction::add_step(ReqType req, const uint8_t *payload, uint8_t len, uint8_t depends_on, ReportType report,
+                             uint32_t report_timeout_ms, ReportCheck check, bool always, uint8_t units) {
+  if (this->running_ || this->num_steps_ >= MAX_TRANSACTION_STEPS || len > MAX_STEP_PAYLOAD) {
+    ESP_LOGE(TAG, "Can't add step for request 0x%02X", static_cast<uint8_t>(req));
+    return -1;
+  }
+
+  Step &step = this->steps_[this->num_steps_];
+  step.req = req;
+  if (len > 0) {
+    memcpy(step.payload, payload, len);
+  }
+  step.len = len;
+  // only earlier steps, so dependencies can't form a cycle
+  step.depends_on = depends_on & ((1u << this->num_steps_) - 1);
+  step.always = always;
+  step.report = report;
+  step.report_timeout_ms = report_timeout_ms;
+  step.check = check;
+  step.units = units;
+  step.state = StepState::PENDING;
+  return this->num_steps_++;
+}
+
+bool Transaction::start(P530Component *parent, uint32_t ack_timeout_ms, CompleteCallback &&on_complete) {
+  if (this->running_) {
+    ESP_LOGW(TAG, "Transaction is still running");
+    return false;
+  }
+
+  this->parent_ = parent;
+  this->ack_timeout_ms_ = ack_timeout_ms;
+  this->on_complete_ = std::move(on_complete);
+  this->result_ = ErrorCode::OK;
+  this->run_++;
+  this->running_ = true;
+  this->cancelled_ = false;
+  for (uint8_t i = 0; i < this->num_steps_; i++) {
+    this->steps_[i].state = StepState::PENDING;
+  }
+
+  ESP_LOGD(TAG, "Start transaction with %u steps", this->num_steps_);
+  this->advance_();
+  return true;
+}
+
+void Transaction::cancel() {
+  if (!this->running_) {
+    return;
+  }
+
+  ESP_LOGD(TAG, "Cancel transaction");
+  this->on_complete_ = nullptr;
+  this->cancelled_ = true;
+  this->advance_();
+}
+
+void Transaction::advance_() {
+  bool all_finished;
+  bool changed;
+  do {
+    all_finished = true;
+    changed = false;
+    uint8_t finished = 0;
+    uint8_t failed = 0;
+    for (uint8_t i = 0; i < this->num_steps_; i++) {
+      switch (this->steps_[i].state) {
+        case StepState::DONE:
+          finished |= 1 << i;
+          break;
+        case StepState::FAILED:
+        case StepState::SKIPPED:
+          finished |= 1 << i;
+          failed |= 1 << i;
+          break;
+        default:
+          break;
+      }
+    }
+
+    for (uint8_t i = 0; i < this->num_steps_; i++) {
+      Step &step = this->steps_[i];
+      if (step.state == StepState::WAIT_ACK || step.state == StepState::WAIT_REPORT) {
+        all_finished = false;
+        continue;
+      }
+      if (step.state != StepState::PENDING) {
+        continue;
+      }
+
+      if ((step.depends_on & finished) != step.depends_on) {
+        // waiting for dependencies
+        all_finished = false;
+        continue;
+      }
+
+      if (((step.depends_on & failed) != 0 || this->cancelled_) && !step.always) {
+        ESP_LOGD(TAG, "Skip request 0x%02X, %s", static_cast<uint8_t>(step.req),
+                 this->cancelled_ ? "cancelled" : "a dependency failed");
+        step.state = StepState::SKIPPED;
+        // may release later steps, which need another pass
+        changed = true;
+        continue;
+      }
+
+      step.seq = this->parent_->send(step.req, step.payload, step.len);
+      if (step.seq == MAX_SEQ || !this->add_waiter_(i, static_cast<uint8_t>(step.req), this->ack_timeout_ms_)) {
+        this->finish_step_(i, ErrorCode::SEND_FAILED);
+        changed = true;
+        continue;
+      }
+      step.state = StepState::WAIT_ACK;
+      all_finished = false;
+    }
+  } while (changed);
+
+  if (!all_finished || !this->running_) {
+    return;
+  }
+
+  ESP_LOGD(TAG, "Transaction complete: %u", static_cast<uint8_t>(this->result_));
+  this->running_ = false;
+  // the callback may start the transaction again
+  CompleteCallback on_complete = std::move(this->on_complete_);
+  this->on_complete_ = nullptr;
+  if (on_complete) {
+    on_complete(this->result_);
+  }
+}
+
+bool Transaction::add_waiter_(uint8_t step, uint8_t type, uint32_t timeout_ms) {
+  // Packing step and run into one word keeps the callback within std::function's small buffer
+  const uint32_t tag = (this->run_ << 8) | step;
+  return this->parent_->add_report_waiter(
+      type, this->steps_[step].seq, timeout_ms, [this, tag](ErrorCode err, const std::span<const uint8_t> payload) {
+        return this->on_packet_(tag & 0xFF, tag >> 8, err, payload);
+      });
+}
+
+bool Transaction::on_packet_(uint8_t step_index, uint32_t run, ErrorCode err, std::span<const uint8_t> payload) {
+  if (!this->running_ || run != (this->run_ & 0x00FFFFFF)) {
+    // left over from a previous run
+    return true;
+  }
+
+  Step &step = this->steps_[step_index];
+  switch (step.state) {
+    case StepState::WAIT_ACK:
+      if (err != ErrorCode::OK) {
+        break;
+      }
+      if (payload.size() != 1 || payload[0] != 0x01) {
+        // not ACK
+        return false;
+      }
+      if (step.report == ReportType::NONE) {
+        break;
+      }
+
+      step.state = StepState::WAIT_REPORT;
+      step.ack_ms = millis();
+      if (!this->add_waiter_(step_index, static_cast<uint8_t>(step.report),
+                             this->parent_->get_completion_timeout(step.report, step.units, step.report_timeout_ms))) {
+        err = ErrorCode::SEND_FAILED;
+        break;
+      }
+      return true;
+
+    case StepState::WAIT_REPORT:
+      if (err == ErrorCode::OK && step.check != nullptr) {
+        err = step.check(payload);
+        if (err == ErrorCode::NOT_IMPLEMENTED) {
+          // not the final report
+          return false;
+        }
+      }
+      if (err == ErrorCode::OK) {
+        this->parent_->add_completion_sample(step.report, step.units, millis() - step.ack_ms);
+      }
+      break;
+
+    default:
+      return true;
+  }
+
+  this->finish_step_(step_index, err);
+  this->advance_();
+  return true;
+}
+
+void Transaction::finish_step_(uint8_t step, ErrorCode err) {
+  Step &s = this->steps_[step];
+  if (err == ErrorCode::OK) {
+    s.state = StepState::DONE;
+    return;
+  }
+
+  ESP_LOGW(TAG, "Request 0x%02X failed: %u", static_cast<uint8_t>(s.req), static_cast<uint8_t>(err));
+  s.state = StepState::FAILED;
+  if (this->result_ == ErrorCode::OK) {
+    this->result_ = err;
+  }
+}
+
+}  // namespace pkt_p530
+}  // namespace esphome
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "protocol.h"
+#include "waiter_table.h"
+
+#include <stdint.h>
+
+#include <functional>
+#include <span>
+
+namespace esphome {
+namespace pkt_p530 {
+
+class P530Component;
+enum class ErrorCode : uint8_t;
+
+static const uint8_t MAX_TRANSACTION_STEPS = 8;
+static const uint8_t MAX_STEP_PAYLOAD = 12;
+
+// Checks a report for a request: OK or an error if it is the final one, NOT_IMPLEMENTED if it is not (yet)
+using ReportCheck = ErrorCode (*)(std::span<const uint8_t> payload);
+
+// Door reports: 0x02 means the door reached its position
+ErrorCode check_door_report(std::span<const uint8_t> payload);
+// Dispense reports are sent while dispensing as well, the third byte is set once done
+ErrorCode check_dispense_report(std::span<const uint8_t> payload);
+
+// A set of requests completing as one. Each step is sent as soon as the steps it depends on finished, so
+// independent steps (e.g. a beep alongside door motion) are in flight together and their ACKs may arrive in any
+// order. A step waits for its ACK and optionally a report.
+//
+// If a dependency failed the step is skipped, unless it always runs (e.g. closing the door after dispensing). The
+// transaction completes once no step is left, with the first error that occurred.
+class Transaction {
+ public:
+  using CompleteCallback = std::function<void(ErrorCode)>;
+
+  // Remove all steps, not allowed while running.
+  void clear() { this->num_steps_ = 0; }
+
+  // Add a step and return its index, -1 if there is no room. depends_on is a bit mask of step indices.
+  // report_timeout_ms is the minimum wait, extended when the measured report time (scaled by units) is longer.
+  int8_t add_step(ReqType req, const uint8_t *payload, uint8_t len, uint8_t depends_on = 0,
+                  ReportType report = ReportType::NONE, uint32_t report_timeout_ms = 0, ReportCheck check = nullptr,
+                  bool always = false, uint8_t units = 1);
+
+  // Send the steps, ack_timeout_ms applies to every request. Returns false if the transaction is still running.
+  bool start(P530Component *parent, uint32_t ack_timeout_ms, CompleteCallback &&on_complete);
+
+  // Drop the completion callback and skip the steps not sent yet once their dependencies finished. Steps in flight
+  // complete and the steps that always run are still sent in order, so the door is closed again.
+  void cancel();
+
+  bool is_running() const { return this->running_; }
+
+ protected:
+  enum class StepState : uint8_t {
+    PENDING,
+    WAIT_ACK,
+    WAIT_REPORT,
+    DONE,
+    FAILED,
+    SKIPPED,
+  };
+
+  struct Step {
+    ReqType req;
+    uint8_t payload[MAX_STEP_PAYLOAD];
+    uint8_t len;
+    uint8_t depends_on;
+    bool always;
+    ReportType report;
+    uint32_t report_timeout_ms;
+    ReportCheck check;
+    uint8_t units;
+    uint8_t seq;
+    uint32_t ack_ms;
+    StepState state;
+  };
+
+  // Send the steps that became ready, complete the transaction once every step finished
+  void advance_();
+  bool on_packet_(uint8_t step, uint32_t run, ErrorCode err, std::span<const uint8_t> payload);
+  void finish_step_(uint8_t step, ErrorCode err);
+  bool add_waiter_(uint8_t step, uint8_t type, uint32_t timeout_ms);
+
+  Step steps_[MAX_TRANSACTION_STEPS];
+  uint8_t num_steps_{0};
+  P530Component *parent_{nullptr};
+  uint32_t ack_timeout_ms_{0};
+  CompleteCallback on_complete_;
+  ErrorCode result_{};
+  // replies to a previous run are ignored
+  uint32_t run_{0};
+  bool running_{false};
+  bool cancelled_{false};
+};
+
+}  // namespace pkt_p530
+}  // namespace esphome
@@ -0,0 +1,205 @@
+#include "waiter_table.h"
+#include "p530_component.h"
+
+#include <esphome/core/log.h>
+
+#include <utility>
+
+namespace esphome {
+namespace pkt_p530 {
+
+namespace {
+static const char *const TAG = "pkt_p530.waiters";
+}  // namespace
+
+WaiterTable::WaiterTable() {
+  for (uint8_t i = 0; i < MAX_WAITERS; i++) {
+    this->waiters_[i].next = i + 1 < MAX_WAITERS ? i + 1 : NO_WAITER;
+  }
+
+  for (auto &bucket : this->buckets_) {
+    bucket = NO_WAITER;
+  }
+}
+
+bool WaiterTable::add(uint8_t type, uint8_t seq, uint32_t deadline_ms, ReportCallback &&callback) {
+  if (this->free_ == NO_WAITER) {
+    ESP_LOGE(TAG, "Too many waiters, dropping: type=0x%02X seq=0x%02X", type, seq);
+    return false;
+  }
+
+  uint8_t index = this->free_;
+  ReportWaiter &waiter = this->waiters_[index];
+  this->free_ = waiter.next;
+  this->count_++;
+
+  waiter.type = type;
+  waiter.seq = seq;
+  waiter.deadline_ms = deadline_ms;
+  waiter.callback = std::move(callback);
+
+  uint8_t &bucket = this->buckets_[bucket_(type, seq)];
+  waiter.next = bucket;
+  bucket = index;
+
+  waiter.heap_pos = NO_WAITER;
+  if (deadline_ms != 0) {
+    waiter.heap_pos = this->heap_size_;
+    this->heap_[this->heap_size_++] = index;
+    this->heap_sift_up_(waiter.heap_pos);
+  }
+
+  return true;
+}
+
+void WaiterTable::dispatch(uint8_t type, uint8_t seq, std::span<const uint8_t> payload) {
+  if (this->count_ == 0) {
+    return;
+  }
+
+  // collect first, the callbacks may add waiters
+  uint8_t matched[MAX_WAITERS];
+  uint8_t num_matched = 0;
+  uint8_t buckets[2] = {bucket_(type, seq), bucket_(type, 0)};
+  uint8_t num_buckets = buckets[0] == buckets[1] ? 1 : 2;
+  for (uint8_t b = 0; b < num_buckets; b++) {
+    for (uint8_t i = this->buckets_[buckets[b]]; i != NO_WAITER; i = this->waiters_[i].next) {
+      const ReportWaiter &waiter = this->waiters_[i];
+      if (waiter.type == type && (waiter.seq == 0 || waiter.seq == seq)) {
+        matched[num_matched++] = i;
+      }
+    }
+  }
+
+  for (uint8_t m = 0; m < num_matched; m++) {
+    ReportWaiter &waiter = this->waiters_[matched[m]];
+    uint8_t waiter_seq = waiter.seq;
+    uint32_t deadline_ms = waiter.deadline_ms;
+    ReportCallback callback = std::move(waiter.callback);
+    this->remove_(matched[m]);
+
+    if (!callback(ErrorCode::OK, payload)) {
+      // Callback rejected the payload, re-register the waiter
+      ESP_LOGV(TAG, "Waiter rejected packet, re-registering: type=0x%02X seq=0x%02X", type, waiter_seq);
+      if (!this->add(type, waiter_seq, deadline_ms, std::move(callback))) {
+        // the callbacks took the freed slot, add() leaves the callback alone when the table is full
+        callback(ErrorCode::SEND_FAILED, {});
+      }
+      continue;
+    }
+
+    ESP_LOGD(TAG, "Waiter matched: type=0x%02X seq=0x%02X", type, waiter_seq);
+  }
+}
+
+void WaiterTable::expire(uint32_t now, const ExpiredCallback &on_expired) {
+  while (this->heap_size_ > 0) {
+    uint8_t index = this->heap_[0];
+    ReportWaiter &waiter = this->waiters_[index];
+    if (static_cast<int32_t>(now - waiter.deadline_ms) < 0) {
+      return;
+    }
+
+    ESP_LOGD(TAG, "Waiter timeout: type=0x%02X seq=0x%02X", waiter.type, waiter.seq);
+    uint8_t type = waiter.type;
+    uint8_t seq = waiter.seq;
+    ReportCallback callback = std::move(waiter.callback);
+    this->remove_(index);
+    callback(ErrorCode::TIMEOUT, {});
+    if (on_expired) {
+      on_expired(type, seq);
+    }
+  }
+}
+
+void WaiterTable::fail(uint8_t type, uint8_t seq, ErrorCode err) {
+  // collect first, the callbacks may add waiters
+  uint8_t matched[MAX_WAITERS];
+  uint8_t num_matched = 0;
+  for (uint8_t i = this->buckets_[bucket_(type, seq)]; i != NO_WAITER; i = this->waiters_[i].next) {
+    if (this->waiters_[i].type == type && this->waiters_[i].seq == seq) {
+      matched[num_matched++] = i;
+    }
+  }
+
+  for (uint8_t m = 0; m < num_matched; m++) {
+    ESP_LOGD(TAG, "Waiter failed: type=0x%02X seq=0x%02X", type, seq);
+    ReportCallback callback = std::move(this->waiters_[matched[m]].callback);
+    this->remove_(matched[m]);
+    callback(err, {});
+  }
+}
+
+void WaiterTable::remove_(uint8_t index) {
+  ReportWaiter &waiter = this->waiters_[index];
+  for (uint8_t *link = &this->buckets_[bucket_(waiter.type, waiter.seq)]; *link != NO_WAITER;
+       link = &this->waiters_[*link].next) {
+    if (*link == index) {
+      *link = waiter.next;
+      break;
+    }
+  }
+
+  if (waiter.heap_pos != NO_WAITER) {
+    uint8_t pos = waiter.heap_pos;
+    this->heap_size_--;
+    if (pos != this->heap_size_) {
+      this->heap_swap_(pos, this->heap_size_);
+      this->heap_sift_up_(pos);
+      this->heap_sift_down_(pos);
+    }
+  }
+
+  waiter.callback = nullptr;
+  waiter.next = this->free_;
+  this->free_ = index;
+  this->count_--;
+}
+
+bool WaiterTable::heap_before_(uint8_t a, uint8_t b) const {
+  return static_cast<int32_t>(this->waiters_[this->heap_[a]].deadline_ms -
+                              this->waiters_[this->heap_[b]].deadline_ms) < 0;
+}
+
+void WaiterTable::heap_swap_(uint8_t a, uint8_t b) {
+  std::swap(this->heap_[a], this->heap_[b]);
+  this->waiters_[this->heap_[a]].heap_pos = a;
+  this->waiters_[this->heap_[b]].heap_pos = b;
+}
+
+void WaiterTable::heap_sift_up_(uint8_t pos) {
+  while (pos > 0) {
+    uint8_t parent = (pos - 1) / 2;
+    if (!this->heap_before_(pos, parent)) {
+      return;
+    }
+
+    this->heap_swap_(pos, parent);
+    pos = parent;
+  }
+}
+
+void WaiterTable::heap_sift_down_(uint8_t pos) {
+  while (true) {
+    uint8_t first = pos;
+    uint8_t left = 2 * pos + 1;
+    uint8_t right = left + 1;
+    if (left < this->heap_size_ && this->heap_before_(left, first)) {
+      first = left;
+    }
+
+    if (right < this->heap_size_ && this->heap_before_(right, first)) {
+      first = right;
+    }
+
+    if (first == pos) {
+      return;
+    }
+
+    this->heap_swap_(pos, first);
+    pos = first;
+  }
+}
+
+}  // namespace pkt_p530
+}  // namespace esphome
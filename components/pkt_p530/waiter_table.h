@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <functional>
+#include <span>
+
+namespace esphome {
+namespace pkt_p530 {
+
+enum class ErrorCode : uint8_t;
+
+using ReportCallback = std::function<bool(ErrorCode, const std::span<const uint8_t> payload)>;
+// Told the type and seq of every waiter that timed out
+using ExpiredCallback = std::function<void(uint8_t type, uint8_t seq)>;
+
+static const uint8_t MAX_WAITERS = 16;
+static const uint8_t WAITER_BUCKETS = 16;
+static const uint8_t NO_WAITER = 0xFF;
+
+struct ReportWaiter {
+  uint8_t type;
+  uint8_t seq;
+  uint32_t deadline_ms;
+  ReportCallback callback;
+  // next waiter in the same bucket, or in the free list
+  uint8_t next;
+  // position in the deadline heap, NO_WAITER for waiters without a deadline
+  uint8_t heap_pos;
+};
+
+// Fixed capacity table of report waiters. Waiters are chained into buckets by (type, seq), so a packet only looks
+// at the waiters it can match, and the deadlines form a min-heap, so expiring them only looks at the earliest one.
+// Nothing is allocated after construction, as long as the callbacks fit into std::function's small buffer.
+class WaiterTable {
+ public:
+  WaiterTable();
+
+  // A deadline of 0 waits forever, seq 0 matches any seq. Returns false if the table is full.
+  bool add(uint8_t type, uint8_t seq, uint32_t deadline_ms, ReportCallback &&callback);
+
+  // Call the waiters matching a packet. Waiters whose callback rejects the packet keep waiting, the others are
+  // removed. A rejecting waiter that finds the table full is called again with SEND_FAILED.
+  void dispatch(uint8_t type, uint8_t seq, std::span<const uint8_t> payload);
+
+  // Remove the waiters whose deadline passed and call them with a timeout, then on_expired (if set).
+  void expire(uint32_t now, const ExpiredCallback &on_expired = nullptr);
+
+  // Remove the waiters for exactly this type and seq, e.g. for a request that was given up, and call them with err.
+  void fail(uint8_t type, uint8_t seq, ErrorCode err);
+
+  bool empty() const { return this->count_ == 0; }
+
+ protected:
+  static uint8_t bucket_(uint8_t type, uint8_t seq) { return (type * 31 + seq) % WAITER_BUCKETS; }
+  // Unlink a waiter from its bucket and the heap and return its slot to the free list
+  void remove_(uint8_t index);
+  void heap_swap_(uint8_t a, uint8_t b);
+  void heap_sift_up_(uint8_t pos);
+  void heap_sift_down_(uint8_t pos);
+  bool heap_before_(uint8_t a, uint8_t b) const;
+
+  ReportWaiter waiters_[MAX_WAITERS];
+  uint8_t buckets_[WAITER_BUCKETS];
+  uint8_t heap_[MAX_WAITERS];
+  uint8_t heap_size_{0};
+  uint8_t free_{0};
+  uint8_t count_{0};
+};
+
+}  // namespace pkt_p530
+}  // namespace esphome
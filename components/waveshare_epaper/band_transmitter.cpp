@@ -0,0 +1,89 @@
+#include "band_transmitter.h"
+
+#ifdef USE_ESP32
+
+#include "esphome/core/application.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace waveshare_epaper {
+
+static const char *const TAG = "waveshare_epaper.band_transmitter";
+
+bool BandTransmitter::init(uint32_t band_length, Writer &&writer) {
+  this->writer_ = std::move(writer);
+  // init() runs on the task doing the rendering later on
+  this->render_handle_ = xTaskGetCurrentTaskHandle();
+
+  RAMAllocator<uint8_t> allocator;
+  for (auto &buffer : this->buffers_) {
+    buffer = allocator.allocate(band_length);
+    if (buffer == nullptr) {
+      ESP_LOGE(TAG, "Could not allocate band buffer!");
+      return false;
+    }
+  }
+
+#if portNUM_PROCESSORS > 1
+  // the loop task normally runs on core 1
+  const BaseType_t core = 0;
+#else
+  const BaseType_t core = tskNO_AFFINITY;
+#endif
+  if (xTaskCreatePinnedToCore(task_, "epaper_tx", 4096, this, 5, &this->task_handle_, core) != pdPASS) {
+    ESP_LOGE(TAG, "Could not start the transmit task!");
+    return false;
+  }
+  return true;
+}
+
+uint8_t *BandTransmitter::acquire() {
+  const uint32_t head = this->head_.load(std::memory_order_relaxed);
+  while (head - this->tail_.load(std::memory_order_acquire) >= NUM_BANDS)
+    this->wait_time_ += this->wait_for_transmit_();
+  return this->buffers_[head % NUM_BANDS];
+}
+
+void BandTransmitter::submit(uint32_t length) {
+  const uint32_t head = this->head_.load(std::memory_order_relaxed);
+  this->queue_[head % NUM_BANDS] = {this->buffers_[head % NUM_BANDS], length};
+  this->head_.store(head + 1, std::memory_order_release);
+  xTaskNotifyGive(this->task_handle_);
+}
+
+uint32_t BandTransmitter::flush() {
+  while (this->tail_.load(std::memory_order_acquire) != this->head_.load(std::memory_order_relaxed))
+    this->wait_time_ += this->wait_for_transmit_();
+  const uint32_t wait_time = this->wait_time_;
+  this->wait_time_ = 0;
+  return wait_time;
+}
+
+uint32_t BandTransmitter::wait_for_transmit_() {
+  const uint32_t start = millis();
+  // the timeout only keeps the watchdog fed if a transfer takes unusually long
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+  App.feed_wdt();
+  return millis() - start;
+}
+
+void BandTransmitter::task_(void *arg) {
+  auto *transmitter = static_cast<BandTransmitter *>(arg);
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    uint32_t tail = transmitter->tail_.load(std::memory_order_relaxed);
+    while (tail != transmitter->head_.load(std::memory_order_acquire)) {
+      const Band &band = transmitter->queue_[tail % NUM_BANDS];
+      transmitter->writer_(band.data, band.length);
+      transmitter->tail_.store(++tail, std::memory_order_release);
+      xTaskNotifyGive(transmitter->render_handle_);
+    }
+  }
+}
+
+}  // namespace waveshare_epaper
+}  // namespace esphome
+
+#endif  // USE_ESP32
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+
+#ifdef USE_ESP32
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace esphome {
+namespace waveshare_epaper {
+
+// Sends rendered bands from a separate task, so the next band can be rendered while the previous one is still
+// going out over SPI. Bands are handed over through a single producer, single consumer ring of descriptors: the
+// render side only advances head_, the transmit task only advances tail_, so neither side takes a lock. Both only
+// ever grow, the number of queued bands is their difference.
+//
+// The render side owns a band buffer from acquire() until submit(), the transmit task from submit() until the band
+// was written. On dual-core chips the task runs on the other core than the loop task.
+class BandTransmitter {
+ public:
+  using Writer = std::function<void(const uint8_t *, size_t)>;
+
+  // Allocate the band buffers and start the transmit task, which passes every submitted band to writer.
+  bool init(uint32_t band_length, Writer &&writer);
+
+  // Buffer to render the next band into, waits until the transmit task released it.
+  uint8_t *acquire();
+  // Queue the buffer returned by the last acquire() with length bytes for transmission.
+  void submit(uint32_t length);
+  // Wait until all queued bands were written. Returns the time in ms the render side spent waiting for the
+  // transmit task since the previous flush.
+  uint32_t flush();
+
+ protected:
+  struct Band {
+    const uint8_t *data;
+    uint32_t length;
+  };
+
+  static void task_(void *arg);
+  // Block until the transmit task signals progress, returns the time waited in ms
+  uint32_t wait_for_transmit_();
+
+  static const uint8_t NUM_BANDS = 2;
+
+  uint8_t *buffers_[NUM_BANDS]{};
+  Band queue_[NUM_BANDS]{};
+  std::atomic<uint32_t> head_{0};
+  std::atomic<uint32_t> tail_{0};
+  Writer writer_;
+  TaskHandle_t task_handle_{nullptr};
+  TaskHandle_t render_handle_{nullptr};
+  uint32_t wait_time_{0};
+};
+
+}  // namespace waveshare_epaper
+}  // namespace esphome
+
+#endif  // USE_ESP32
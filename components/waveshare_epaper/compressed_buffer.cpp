@@ -0,0 +1,186 @@
+#include "compressed_buffer.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include "esphome/core/application.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace waveshare_epaper {
+
+static const char *const TAG = "waveshare_epaper.compressed";
+
+bool CompressedBuffer::init(uint32_t length, uint32_t band_length, uint8_t unit_size) {
+  this->length_ = length;
+  this->band_length_ = band_length;
+  this->unit_size_ = unit_size;
+  this->bands_.resize((length + band_length - 1) / band_length);
+
+  RAMAllocator<uint8_t> allocator;
+  for (auto &slot : this->cache_) {
+    slot.data = allocator.allocate(band_length);
+    if (slot.data == nullptr) {
+      ESP_LOGE(TAG, "Could not allocate band cache!");
+      return false;
+    }
+  }
+  ESP_LOGD(TAG, "%" PRIu32 " bands of %" PRIu32 " bytes, %u cached", (uint32_t) this->bands_.size(), band_length,
+           CACHE_SIZE);
+  return true;
+}
+
+uint32_t CompressedBuffer::get_band_size_(uint32_t band) const {
+  return std::min(this->band_length_, this->length_ - band * this->band_length_);
+}
+
+void CompressedBuffer::load_band_(uint32_t band) {
+  // evict the least recently used slot
+  CacheSlot *slot = &this->cache_[0];
+  for (auto &candidate : this->cache_) {
+    if (candidate.band == (int32_t) band) {
+      slot = &candidate;
+      break;
+    }
+    if (candidate.last_use < slot->last_use)
+      slot = &candidate;
+  }
+
+  if (slot->band != (int32_t) band) {
+    if (slot->band >= 0 && slot->dirty)
+      this->encode_band_(slot->band, slot->data);
+    this->decode_band_(band, slot->data);
+    slot->band = band;
+    slot->dirty = false;
+  }
+  slot->last_use = ++this->use_counter_;
+  this->last_slot_ = slot;
+}
+
+void CompressedBuffer::decode_band_(uint32_t band, uint8_t *out) const {
+  const std::vector<uint8_t> &encoded = this->bands_[band];
+  const uint8_t unit_size = this->unit_size_;
+  size_t pos = 0;
+  while (pos < encoded.size()) {
+    const uint8_t token = encoded[pos++];
+    const uint32_t count = (token & 0x7F) + 1;
+    if (token & 0x80) {
+      for (uint32_t i = 0; i < count; i++, out += unit_size)
+        memcpy(out, &encoded[pos], unit_size);
+      pos += unit_size;
+    } else {
+      memcpy(out, &encoded[pos], count * unit_size);
+      out += count * unit_size;
+      pos += count * unit_size;
+    }
+  }
+}
+
+void CompressedBuffer::encode_band_(uint32_t band, const uint8_t *in) {
+  const uint8_t unit_size = this->unit_size_;
+  const uint32_t units = this->get_band_size_(band) / unit_size;
+  auto same = [in, unit_size](uint32_t a, uint32_t b) {
+    return memcmp(in + a * unit_size, in + b * unit_size, unit_size) == 0;
+  };
+
+  std::vector<uint8_t> &out = this->scratch_;
+  out.clear();
+  uint32_t i = 0;
+  while (i < units) {
+    uint32_t run = 1;
+    while (i + run < units && run < MAX_TOKEN_UNITS && same(i, i + run))
+      run++;
+    if (run > 1) {
+      out.push_back(0x80 | (run - 1));
+      out.insert(out.end(), in + i * unit_size, in + (i + 1) * unit_size);
+      i += run;
+      continue;
+    }
+
+    // collect literal units up to the start of the next run
+    const uint32_t start = i++;
+    while (i < units && i - start < MAX_TOKEN_UNITS && !(i + 1 < units && same(i, i + 1)))
+      i++;
+    out.push_back(i - start - 1);
+    out.insert(out.end(), in + start * unit_size, in + i * unit_size);
+  }
+  // exact fit, a band that compressed badly once should not keep its memory
+  this->bands_[band].assign(out.begin(), out.end());
+  this->bands_[band].shrink_to_fit();
+}
+
+void CompressedBuffer::fill(const uint8_t *unit) {
+  for (auto &slot : this->cache_) {
+    slot.band = -1;
+    slot.dirty = false;
+  }
+  this->last_slot_ = nullptr;
+
+  for (uint32_t band = 0; band < this->bands_.size(); band++) {
+    std::vector<uint8_t> &encoded = this->bands_[band];
+    encoded.clear();
+    uint32_t units = this->get_band_size_(band) / this->unit_size_;
+    while (units > 0) {
+      const uint32_t run = std::min<uint32_t>(units, MAX_TOKEN_UNITS);
+      encoded.push_back(0x80 | (run - 1));
+      encoded.insert(encoded.end(), unit, unit + this->unit_size_);
+      units -= run;
+    }
+    encoded.shrink_to_fit();
+  }
+}
+
+void CompressedBuffer::write_run_(const uint8_t *unit, uint32_t count,
+                                  const std::function<void(const uint8_t *, size_t)> &writer) {
+  // 96 bytes hold a whole number of units for unit sizes 1, 2, 3 and 4
+  uint8_t chunk[96];
+  const uint32_t chunk_units = std::min<uint32_t>(count, sizeof(chunk) / this->unit_size_);
+  for (uint32_t i = 0; i < chunk_units; i++)
+    memcpy(chunk + i * this->unit_size_, unit, this->unit_size_);
+  while (count > 0) {
+    const uint32_t units = std::min(count, chunk_units);
+    writer(chunk, units * this->unit_size_);
+    count -= units;
+  }
+}
+
+void CompressedBuffer::stream(const std::function<void(const uint8_t *, size_t)> &writer) {
+  for (uint32_t band = 0; band < this->bands_.size(); band++) {
+    // cached bands may be newer than their encoded copy
+    const CacheSlot *cached = nullptr;
+    for (const auto &slot : this->cache_) {
+      if (slot.band == (int32_t) band)
+        cached = &slot;
+    }
+    if (cached != nullptr) {
+      writer(cached->data, this->get_band_size_(band));
+      continue;
+    }
+
+    // literal units are sent straight from the encoded data
+    const std::vector<uint8_t> &encoded = this->bands_[band];
+    size_t pos = 0;
+    while (pos < encoded.size()) {
+      const uint8_t token = encoded[pos++];
+      const uint32_t count = (token & 0x7F) + 1;
+      if (token & 0x80) {
+        this->write_run_(&encoded[pos], count, writer);
+        pos += this->unit_size_;
+      } else {
+        writer(&encoded[pos], count * this->unit_size_);
+        pos += count * this->unit_size_;
+      }
+    }
+    App.feed_wdt();
+  }
+}
+
+uint32_t CompressedBuffer::get_compressed_size() const {
+  uint32_t size = 0;
+  for (const auto &encoded : this->bands_)
+    size += encoded.size();
+  return size;
+}
+
+}  // namespace waveshare_epaper
+}  // namespace esphome
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace esphome {
+namespace waveshare_epaper {
+
+// Frame buffer stored as run-length encoded bands. Pixels are accessed through a small cache of decoded bands,
+// which are encoded again once they get evicted. UI content with large uniform areas typically needs a small
+// fraction of the uncompressed size, noisy content (e.g. photos) slightly more than it.
+//
+// The encoding works on units of unit_size bytes, so colour formats packing several pixels into more than one byte
+// still form runs: a token with the high bit set repeats the following unit (token & 0x7F) + 1 times, otherwise
+// token + 1 literal units follow.
+class CompressedBuffer {
+ public:
+  // length and band_length have to be multiples of unit_size
+  bool init(uint32_t length, uint32_t band_length, uint8_t unit_size);
+
+  // Pointer to the byte at pos for modification, valid until the next call.
+  uint8_t *get(uint32_t pos) {
+    const uint32_t band = pos / this->band_length_;
+    if (this->last_slot_ == nullptr || this->last_slot_->band != (int32_t) band)
+      this->load_band_(band);
+    this->last_slot_->dirty = true;
+    return this->last_slot_->data + (pos - band * this->band_length_);
+  }
+
+  // Set the whole buffer to a repeated unit.
+  void fill(const uint8_t *unit);
+
+  // Decode the buffer in order, passing chunks of whole units to the writer.
+  void stream(const std::function<void(const uint8_t *, size_t)> &writer);
+
+  uint32_t get_compressed_size() const;
+
+ protected:
+  struct CacheSlot {
+    uint8_t *data{nullptr};
+    int32_t band{-1};
+    uint32_t last_use{0};
+    bool dirty{false};
+  };
+
+  uint32_t get_band_size_(uint32_t band) const;
+  void load_band_(uint32_t band);
+  void decode_band_(uint32_t band, uint8_t *out) const;
+  void encode_band_(uint32_t band, const uint8_t *in);
+  void write_run_(const uint8_t *unit, uint32_t count, const std::function<void(const uint8_t *, size_t)> &writer);
+
+  static const uint8_t CACHE_SIZE = 4;
+  static const uint8_t MAX_TOKEN_UNITS = 128;
+
+  std::vector<std::vector<uint8_t>> bands_;
+  std::vector<uint8_t> scratch_;
+  CacheSlot cache_[CACHE_SIZE];
+  CacheSlot *last_slot_{nullptr};
+  uint32_t length_{0};
+  uint32_t band_length_{0};
+  uint32_t use_counter_{0};
+  uint8_t unit_size_{1};
+};
+
+}  // namespace waveshare_epaper
+}  // namespace esphome
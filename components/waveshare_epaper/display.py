@@ -1,6 +1,6 @@
 from esphome import core, pins
 import esphome.codegen as cg
-from esphome.components import display, spi
+from esphome.components import display, sensor, spi
 import esphome.config_validation as cv
 from esphome.const import (
     CONF_BUSY_PIN,
@@ -12,11 +12,33 @@ from esphome.const import (
     CONF_PAGES,
     CONF_RESET_DURATION,
     CONF_RESET_PIN,
+    DEVICE_CLASS_CURRENT,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
 )
 
+AUTO_LOAD = ["sensor"]
 DEPENDENCIES = ["spi"]
 
+CONF_AVERAGE_CURRENT = "average_current"
+CONF_CHARGE = "charge"
+CONF_COMPRESSED_BUFFER = "compressed_buffer"
+CONF_DITHER = "dither"
+CONF_FAST_REFRESH_MIN_TEMPERATURE = "fast_refresh_min_temperature"
+CONF_FULL_LUT = "full_lut"
+CONF_GRAYSCALE = "grayscale"
+CONF_PARTIAL_LUT = "partial_lut"
+CONF_OFF_CURRENT = "off_current"
+CONF_ON_CURRENT = "on_current"
+CONF_PARALLEL_TRANSMIT = "parallel_transmit"
+CONF_POWER_MODE = "power_mode"
 CONF_POWER_PIN = "power_pin"
+CONF_REFRESH_MODE = "refresh_mode"
+CONF_RENDER_BANDS = "render_bands"
+CONF_SKIP_UNCHANGED = "skip_unchanged"
+CONF_SLEEP_CURRENT = "sleep_current"
+CONF_STATIC_LAYER = "static_layer"
+CONF_TEMPERATURE_SENSOR = "temperature_sensor"
 
 waveshare_epaper_ns = cg.esphome_ns.namespace("waveshare_epaper")
 WaveshareEPaperBase = waveshare_epaper_ns.class_(
@@ -156,7 +178,7 @@ MODELS = {
     "2.90in-d": ("b", WaveshareEPaper2P9InD),
     "2.90in-dke": ("c", WaveshareEPaper2P9InDKE),
     "gdey042t81": ("c", GDEY042T81),
-    "4.20in": ("b", WaveshareEPaper4P2In),
+    "4.20in": ("c", WaveshareEPaper4P2In),
     "4.20in-bv2": ("b", WaveshareEPaper4P2InBV2),
     "4.20in-bv2-bwr": ("b", WaveshareEPaper4P2InBV2BWR),
     "5.65in-f": ("b", WaveshareEPaper5P65InF),
@@ -169,8 +191,8 @@ MODELS = {
     "7.50in-bv3": ("b", WaveshareEPaper7P5InBV3),
     "7.50in-bv3-bwr": ("b", WaveshareEPaper7P5InBV3BWR),
     "7.50in-bc": ("b", WaveshareEPaper7P5InBC),
-    "7.50inv2": ("b", WaveshareEPaper7P5InV2),
-    "7.50inv2alt": ("b", WaveshareEPaper7P5InV2alt),
+    "7.50inv2": ("c", WaveshareEPaper7P5InV2),
+    "7.50inv2alt": ("c", WaveshareEPaper7P5InV2alt),
     "7.50inv2p": ("c", WaveshareEPaper7P5InV2P),
     "7.50in-hd-b": ("b", WaveshareEPaper7P5InHDB),
     "7.50in-h": ("b", WaveshareEPaper7P5InH),
@@ -181,6 +203,55 @@ MODELS = {
 }
 
 RESET_PIN_REQUIRED_MODELS = ("2.13inv2", "2.13in-ttgo-b74")
+COMPRESSED_BUFFER_MODELS = ("5.65in-f", "7.30in-f", "13.3in-k")
+RENDER_BANDS_MODELS = ("7.50in-h",)
+DITHER_MODELS = ("7.50in-h",)
+REFRESH_MODE_MODELS = ("2.90inv2-r2", "gdey029t94", "gdey042t81")
+GRAYSCALE_MODELS = ("2.13inv3", "2.90inv2")
+# length of the waveform tables written with the LUT register command (0x32)
+LUT_SIZES = {
+    "1.54in": 30,
+    "1.54inv2": 30,
+    "2.13in": 30,
+    "2.13inv2": 70,
+    "2.13in-ttgo": 70,
+    "2.13in-ttgo-b1": 29,
+    "2.13in-ttgo-b73": 100,
+    "2.90in": 30,
+    "2.90inv2": 30,
+    "2.13inv3": 153,
+}
+
+POWER_MANAGED_MODELS = ("7.50in-h",)
+POWER_OPTIONS = (
+    CONF_POWER_MODE,
+    CONF_ON_CURRENT,
+    CONF_OFF_CURRENT,
+    CONF_SLEEP_CURRENT,
+    CONF_AVERAGE_CURRENT,
+    CONF_CHARGE,
+)
+
+PowerMode = waveshare_epaper_ns.enum("PowerMode")
+POWER_MODES = {
+    "auto": PowerMode.POWER_MODE_AUTO,
+    "always_on": PowerMode.POWER_MODE_ALWAYS_ON,
+    "power_off": PowerMode.POWER_MODE_POWER_OFF,
+    "deep_sleep": PowerMode.POWER_MODE_DEEP_SLEEP,
+}
+PowerState = waveshare_epaper_ns.enum("PowerState")
+STATE_CURRENTS = {
+    CONF_ON_CURRENT: PowerState.POWER_STATE_ON,
+    CONF_OFF_CURRENT: PowerState.POWER_STATE_OFF,
+    CONF_SLEEP_CURRENT: PowerState.POWER_STATE_SLEEP,
+}
+
+RefreshMode = waveshare_epaper_ns.enum("RefreshMode")
+REFRESH_MODES = {
+    "auto": RefreshMode.REFRESH_MODE_AUTO,
+    "fast": RefreshMode.REFRESH_MODE_FAST,
+    "normal": RefreshMode.REFRESH_MODE_NORMAL,
+}
 
 
 def validate_full_update_every_only_types_ac(value):
@@ -198,6 +269,106 @@ def validate_full_update_every_only_types_ac(value):
     return value
 
 
+def validate_compressed_buffer_models(config):
+    if (
+        config.get(CONF_COMPRESSED_BUFFER)
+        and config[CONF_MODEL] not in COMPRESSED_BUFFER_MODELS
+    ):
+        raise cv.Invalid(
+            f"'{CONF_COMPRESSED_BUFFER}' is only available for models "
+            + ", ".join(COMPRESSED_BUFFER_MODELS)
+        )
+    return config
+
+
+def validate_static_layer(config):
+    if CONF_STATIC_LAYER in config and config[CONF_COMPRESSED_BUFFER]:
+        raise cv.Invalid(
+            f"'{CONF_STATIC_LAYER}' can't be used together with '{CONF_COMPRESSED_BUFFER}'"
+        )
+    return config
+
+
+def validate_render_bands_models(config):
+    if CONF_RENDER_BANDS in config and config[CONF_MODEL] not in RENDER_BANDS_MODELS:
+        raise cv.Invalid(
+            f"'{CONF_RENDER_BANDS}' is only available for models "
+            + ", ".join(RENDER_BANDS_MODELS)
+        )
+    if config.get(CONF_PARALLEL_TRANSMIT) and config.get(CONF_RENDER_BANDS, 1) < 2:
+        raise cv.Invalid(
+            f"'{CONF_PARALLEL_TRANSMIT}' needs '{CONF_RENDER_BANDS}' of 2 or more"
+        )
+    return config
+
+
+def validate_dither_models(config):
+    if config[CONF_DITHER] and config[CONF_MODEL] not in DITHER_MODELS:
+        raise cv.Invalid(
+            f"'{CONF_DITHER}' is only available for models "
+            + ", ".join(DITHER_MODELS)
+        )
+    return config
+
+
+def validate_refresh_mode_models(config):
+    if config[CONF_MODEL] in REFRESH_MODE_MODELS:
+        return config
+    for key in (
+        CONF_REFRESH_MODE,
+        CONF_TEMPERATURE_SENSOR,
+        CONF_FAST_REFRESH_MIN_TEMPERATURE,
+    ):
+        if key in config:
+            raise cv.Invalid(
+                f"'{key}' is only available for models "
+                + ", ".join(REFRESH_MODE_MODELS)
+            )
+    return config
+
+
+def validate_grayscale_models(config):
+    if config[CONF_GRAYSCALE] and config[CONF_MODEL] not in GRAYSCALE_MODELS:
+        raise cv.Invalid(
+            f"'{CONF_GRAYSCALE}' is only available for models "
+            + ", ".join(GRAYSCALE_MODELS)
+        )
+    return config
+
+
+def validate_lut_sizes(config):
+    for key in (CONF_FULL_LUT, CONF_PARTIAL_LUT):
+        if key not in config:
+            continue
+        model = config[CONF_MODEL]
+        if model not in LUT_SIZES:
+            raise cv.Invalid(
+                f"'{key}' is only available for models " + ", ".join(LUT_SIZES)
+            )
+        size = LUT_SIZES[model]
+        if key == CONF_FULL_LUT and config[CONF_GRAYSCALE]:
+            # replaces the SSD1680 grayscale waveform
+            size = 153
+        if len(config[key]) != size:
+            raise cv.Invalid(
+                f"'{key}' for model {model} must have {size} bytes, "
+                f"got {len(config[key])}"
+            )
+    return config
+
+
+def validate_power_models(config):
+    if config[CONF_MODEL] in POWER_MANAGED_MODELS:
+        return config
+    for key in POWER_OPTIONS:
+        if key in config:
+            raise cv.Invalid(
+                f"'{key}' is only available for models "
+                + ", ".join(POWER_MANAGED_MODELS)
+            )
+    return config
+
+
 def validate_reset_pin_required(config):
     if config[CONF_MODEL] in RESET_PIN_REQUIRED_MODELS and CONF_RESET_PIN not in config:
         raise cv.Invalid(
@@ -216,6 +387,35 @@ CONFIG_SCHEMA = cv.All(
             cv.Optional(CONF_RESET_PIN): pins.gpio_output_pin_schema,
             cv.Optional(CONF_BUSY_PIN): pins.gpio_input_pin_schema,
             cv.Optional(CONF_FULL_UPDATE_EVERY): cv.int_range(min=1, max=4294967295),
+            cv.Optional(CONF_COMPRESSED_BUFFER, default=False): cv.boolean,
+            cv.Optional(CONF_RENDER_BANDS): cv.int_range(min=1, max=32),
+            cv.Optional(CONF_PARALLEL_TRANSMIT): cv.All(
+                cv.boolean, cv.only_on_esp32
+            ),
+            cv.Optional(CONF_DITHER, default=False): cv.boolean,
+            cv.Optional(CONF_SKIP_UNCHANGED, default=False): cv.boolean,
+            cv.Optional(CONF_STATIC_LAYER): cv.lambda_,
+            cv.Optional(CONF_REFRESH_MODE): cv.enum(REFRESH_MODES, lower=True),
+            cv.Optional(CONF_TEMPERATURE_SENSOR): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_FAST_REFRESH_MIN_TEMPERATURE): cv.temperature,
+            cv.Optional(CONF_GRAYSCALE, default=False): cv.boolean,
+            cv.Optional(CONF_FULL_LUT): cv.ensure_list(cv.hex_uint8_t),
+            cv.Optional(CONF_PARTIAL_LUT): cv.ensure_list(cv.hex_uint8_t),
+            cv.Optional(CONF_POWER_MODE): cv.enum(POWER_MODES, lower=True),
+            cv.Optional(CONF_ON_CURRENT): cv.current,
+            cv.Optional(CONF_OFF_CURRENT): cv.current,
+            cv.Optional(CONF_SLEEP_CURRENT): cv.current,
+            cv.Optional(CONF_AVERAGE_CURRENT): sensor.sensor_schema(
+                unit_of_measurement="mA",
+                accuracy_decimals=3,
+                device_class=DEVICE_CLASS_CURRENT,
+                state_class=STATE_CLASS_MEASUREMENT,
+            ),
+            cv.Optional(CONF_CHARGE): sensor.sensor_schema(
+                unit_of_measurement="mAh",
+                accuracy_decimals=3,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+            ),
             cv.Optional(CONF_RESET_DURATION): cv.All(
                 cv.positive_time_period_milliseconds,
                 cv.Range(max=core.TimePeriod(milliseconds=500)),
@@ -226,6 +426,14 @@ CONFIG_SCHEMA = cv.All(
     .extend(spi.spi_device_schema()),
     validate_full_update_every_only_types_ac,
     validate_reset_pin_required,
+    validate_compressed_buffer_models,
+    validate_static_layer,
+    validate_render_bands_models,
+    validate_dither_models,
+    validate_refresh_mode_models,
+    validate_grayscale_models,
+    validate_power_models,
+    validate_lut_sizes,
     cv.has_at_most_one_key(CONF_PAGES, CONF_LAMBDA),
 )
 
@@ -256,6 +464,13 @@ async def to_code(config):
             config[CONF_LAMBDA], [(display.DisplayRef, "it")], return_type=cg.void
         )
         cg.add(var.set_writer(lambda_))
+    if CONF_STATIC_LAYER in config:
+        static_layer = await cg.process_lambda(
+            config[CONF_STATIC_LAYER],
+            [(display.DisplayRef, "it")],
+            return_type=cg.void,
+        )
+        cg.add(var.set_static_layer(static_layer))
     if CONF_POWER_PIN in config:
         reset = await cg.gpio_pin_expression(config[CONF_POWER_PIN])
         cg.add(var.set_power_pin(reset))
@@ -269,3 +484,42 @@ async def to_code(config):
         cg.add(var.set_full_update_every(config[CONF_FULL_UPDATE_EVERY]))
     if CONF_RESET_DURATION in config:
         cg.add(var.set_reset_duration(config[CONF_RESET_DURATION]))
+    if config[CONF_COMPRESSED_BUFFER]:
+        cg.add(var.set_compressed_buffer(True))
+    if CONF_RENDER_BANDS in config:
+        cg.add(var.set_render_bands(config[CONF_RENDER_BANDS]))
+    if config.get(CONF_PARALLEL_TRANSMIT):
+        cg.add(var.set_parallel_transmit(True))
+    if config[CONF_DITHER]:
+        cg.add(var.set_dither(True))
+    if config[CONF_SKIP_UNCHANGED]:
+        cg.add(var.set_skip_unchanged(True))
+    if CONF_REFRESH_MODE in config:
+        cg.add(var.set_refresh_mode(config[CONF_REFRESH_MODE]))
+    if CONF_TEMPERATURE_SENSOR in config:
+        sens = await cg.get_variable(config[CONF_TEMPERATURE_SENSOR])
+        cg.add(var.set_temperature_sensor(sens))
+    if CONF_FAST_REFRESH_MIN_TEMPERATURE in config:
+        cg.add(
+            var.set_fast_refresh_min_temperature(
+                config[CONF_FAST_REFRESH_MIN_TEMPERATURE]
+            )
+        )
+    if config[CONF_GRAYSCALE]:
+        cg.add(var.set_grayscale(True))
+    if CONF_FULL_LUT in config:
+        cg.add(var.set_full_lut(config[CONF_FULL_LUT]))
+    if CONF_PARTIAL_LUT in config:
+        cg.add(var.set_partial_lut(config[CONF_PARTIAL_LUT]))
+    if CONF_POWER_MODE in config:
+        cg.add(var.set_power_mode(config[CONF_POWER_MODE]))
+    for key, state in STATE_CURRENTS.items():
+        if key in config:
+            # validated in A, used in mA
+            cg.add(var.set_state_current(state, config[key] * 1000))
+    if CONF_AVERAGE_CURRENT in config:
+        sens = await sensor.new_sensor(config[CONF_AVERAGE_CURRENT])
+        cg.add(var.set_average_current_sensor(sens))
+    if CONF_CHARGE in config:
+        sens = await sensor.new_sensor(config[CONF_CHARGE])
+        cg.add(var.set_charge_sensor(sens))
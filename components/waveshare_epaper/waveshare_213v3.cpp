@@ -7,8 +7,9 @@ namespace waveshare_epaper {
 
 static const char *const TAG = "waveshare_2.13v3";
 
-static const uint8_t PARTIAL_LUT[] = {
-    0x32,  // cmd
+static const uint8_t LUT_SIZE = 153;
+
+static const uint8_t PARTIAL_LUT[LUT_SIZE] = {
     0x0,  0x40, 0x0, 0x0, 0x0,  0x0,  0x0,  0x0,  0x0,  0x0,  0x0, 0x0, 0x80, 0x80, 0x0, 0x0, 0x0, 0x0,  0x0, 0x0,
     0x0,  0x0,  0x0, 0x0, 0x40, 0x40, 0x0,  0x0,  0x0,  0x0,  0x0, 0x0, 0x0,  0x0,  0x0, 0x0, 0x0, 0x80, 0x0, 0x0,
     0x0,  0x0,  0x0, 0x0, 0x0,  0x0,  0x0,  0x0,  0x0,  0x0,  0x0, 0x0, 0x0,  0x0,  0x0, 0x0, 0x0, 0x0,  0x0, 0x0,
@@ -19,8 +20,7 @@ static const uint8_t PARTIAL_LUT[] = {
     0x0,  0x0,  0x0, 0x0, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x0, 0x0, 0x0,
 };
 
-static const uint8_t FULL_LUT[] = {
-    0x32,  // CMD
+static const uint8_t FULL_LUT[LUT_SIZE] = {
     0x80, 0x4A, 0x40, 0x0, 0x0,  0x0,  0x0,  0x0,  0x0,  0x0,  0x0, 0x0, 0x40, 0x4A, 0x80, 0x0, 0x0,  0x0,  0x0,  0x0,
     0x0,  0x0,  0x0,  0x0, 0x80, 0x4A, 0x40, 0x0,  0x0,  0x0,  0x0, 0x0, 0x0,  0x0,  0x0,  0x0, 0x40, 0x4A, 0x80, 0x0,
     0x0,  0x0,  0x0,  0x0, 0x0,  0x0,  0x0,  0x0,  0x0,  0x0,  0x0, 0x0, 0x0,  0x0,  0x0,  0x0, 0x0,  0x0,  0x0,  0x0,
@@ -33,6 +33,7 @@ static const uint8_t FULL_LUT[] = {
 
 static const uint8_t SW_RESET = 0x12;
 static const uint8_t ACTIVATE = 0x20;
+static const uint8_t WRITE_LUT = 0x32;
 static const uint8_t WRITE_BUFFER = 0x24;
 static const uint8_t WRITE_BASE = 0x26;
 
@@ -51,34 +52,30 @@ static const uint8_t CMD5[] = {0x37, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0
 static const uint8_t BORDER_PART[] = {0x3C, 0x80};  // border waveform
 static const uint8_t BORDER_FULL[] = {0x3C, 0x05};  // border waveform
 static const uint8_t CMD1[] = {0x3F, 0x22};
-static const uint8_t RAM_X_START[] = {0x44, 0x00, 121 / 8};           // set ram_x_address_start_end
-static const uint8_t RAM_Y_START[] = {0x45, 0x00, 0x00, 250 - 1, 0};  // set ram_y_address_start_end
-static const uint8_t RAM_X_POS[] = {0x4E, 0x00};                      // set ram_x_address_counter
-// static const uint8_t RAM_Y_POS[] = {0x4F, 0x00, 0x00};        // set ram_y_address_counter
 #define SEND(x) this->cmd_data(x, sizeof(x))
 
 void WaveshareEPaper2P13InV3::write_lut_(const uint8_t *lut) {
+  if (!this->lut_needs_load_(lut))
+    return;
   this->wait_until_idle_();
-  this->cmd_data(lut, sizeof(PARTIAL_LUT));
+  this->command(WRITE_LUT);
+  this->write_stream_(lut, LUT_SIZE);
   SEND(CMD1);
   SEND(GATEV);
   SEND(SRCV);
   SEND(VCOM);
 }
 
-// write the buffer starting on line top, up to line bottom.
-void WaveshareEPaper2P13InV3::write_buffer_(uint8_t cmd, int top, int bottom) {
+// write the part of the buffer covered by the window, line by line.
+void WaveshareEPaper2P13InV3::write_buffer_(uint8_t cmd, const FrameWindow &window) {
   this->wait_until_idle_();
-  this->set_window_(top, bottom);
+  this->set_window_(window);
   this->command(cmd);
-  this->start_data_();
-
-  auto width_bytes = this->get_width_controller() / 8;
-  this->write_array(this->buffer_ + top * width_bytes, (bottom - top) * width_bytes);
-  this->end_data_();
+  this->write_window_(this->buffer_, window);
 }
 
 void WaveshareEPaper2P13InV3::send_reset_() {
+  this->invalidate_lut_();
   if (this->reset_pin_ != nullptr) {
     this->reset_pin_->digital_write(false);
     delay(2);
@@ -87,6 +84,7 @@ void WaveshareEPaper2P13InV3::send_reset_() {
 }
 
 void WaveshareEPaper2P13InV3::setup() {
+  this->init_geometry_();
   this->init_internal_(this->get_buffer_length_());
   this->setup_pins_();
   this->spi_setup();
@@ -103,62 +101,109 @@ void WaveshareEPaper2P13InV3::setup() {
   SEND(DRV_OUT_CTL);
   SEND(DATA_ENTRY);
   SEND(CMD5);
-  this->set_window_(0, this->get_height_internal());
+  this->set_window_(this->get_full_window_());
   SEND(BORDER_FULL);
   SEND(DISPLAY_UPDATE);
   SEND(TEMP_SENS);
   this->wait_until_idle_();
-  this->write_lut_(FULL_LUT);
+  this->write_lut_(this->get_lut_(true, FULL_LUT));
 }
 
-// t and b are y positions, i.e. line numbers.
-void WaveshareEPaper2P13InV3::set_window_(int t, int b) {
-  uint8_t buffer[3];
-
-  SEND(RAM_X_START);
-  SEND(RAM_Y_START);
-  SEND(RAM_X_POS);
-  buffer[0] = 0x4F;
-  buffer[1] = (uint8_t) t;
-  buffer[2] = (uint8_t) (t >> 8);
-  SEND(buffer);
+// program the RAM window and move the address counters to its start.
+// x positions are in bytes, y positions are line numbers.
+void WaveshareEPaper2P13InV3::set_window_(const FrameWindow &window) {
+  const int l = window.left;
+  const int r = window.right - 1;
+  const int t = window.top;
+  const int b = window.bottom - 1;
+
+  // ram x/y address start and end, followed by the ram x/y address counters
+  const uint8_t ram_x_start[] = {0x44, (uint8_t) l, (uint8_t) r};
+  const uint8_t ram_y_start[] = {0x45, (uint8_t) t, (uint8_t) (t >> 8), (uint8_t) b, (uint8_t) (b >> 8)};
+  const uint8_t ram_x_pos[] = {0x4E, (uint8_t) l};
+  const uint8_t ram_y_pos[] = {0x4F, (uint8_t) t, (uint8_t) (t >> 8)};
+  SEND(ram_x_start);
+  SEND(ram_y_start);
+  SEND(ram_x_pos);
+  SEND(ram_y_pos);
 }
 
 // must implement, but we override setup to have more control
 void WaveshareEPaper2P13InV3::initialize() {}
 
 void WaveshareEPaper2P13InV3::partial_update_() {
+  FrameWindow window;
+  if (!this->get_changed_window_(window)) {
+    ESP_LOGD(TAG, "Nothing changed, skipping partial update.");
+    this->is_busy_ = false;
+    return;
+  }
+
+  const uint8_t *lut = this->get_lut_(false, PARTIAL_LUT);
+  if (this->loaded_lut_ == lut) {
+    // still set up by the previous partial update, the reset would only clear the LUT again
+    this->write_partial_(window);
+    return;
+  }
+  // the window was computed from the current buffer, so no update may render into it before it is sent
+  this->refresh_pending_ = true;
   this->send_reset_();
-  this->set_timeout(100, [this] {
-    this->write_lut_(PARTIAL_LUT);
+  this->set_timeout(100, [this, window, lut] {
+    this->write_lut_(lut);
     SEND(BORDER_PART);
     SEND(UPSEQ);
     this->command(ACTIVATE);
-    this->set_timeout(100, [this] {
-      this->wait_until_idle_();
-      this->write_buffer_(WRITE_BUFFER, 0, this->get_height_internal());
-      SEND(ON_PARTIAL);
-      this->command(ACTIVATE);  // Activate Display Update Sequence
-      this->is_busy_ = false;
+    this->set_timeout(100, [this, window] {
+      this->refresh_pending_ = false;
+      this->write_partial_(window);
     });
   });
 }
 
+void WaveshareEPaper2P13InV3::write_partial_(const FrameWindow &window) {
+  this->wait_until_idle_();
+  this->write_buffer_(WRITE_BUFFER, window);
+  this->store_old_buffer_();
+  SEND(ON_PARTIAL);
+  this->command(ACTIVATE);  // Activate Display Update Sequence
+  this->time_refresh_(false);
+  this->is_busy_ = false;
+}
+
 void WaveshareEPaper2P13InV3::full_update_() {
   ESP_LOGI(TAG, "Performing full e-paper update.");
-  this->write_lut_(FULL_LUT);
-  this->write_buffer_(WRITE_BUFFER, 0, this->get_height_internal());
-  this->write_buffer_(WRITE_BASE, 0, this->get_height_internal());
+  const FrameWindow window = this->get_full_window_();
+  if (this->grayscale_) {
+    // the waveform drives each pixel by its bits in both RAMs, the low bit goes to the new data RAM
+    this->write_lut_(this->get_lut_(true, SSD1680_GRAYSCALE_LUT));
+    this->wait_until_idle_();
+    this->set_window_(window);
+    this->command(WRITE_BUFFER);
+    this->write_stream_(this->buffer_, this->get_buffer_length_(), STREAM_GRAY_LOW);
+    this->set_window_(window);
+    this->command(WRITE_BASE);
+    this->write_stream_(this->buffer_, this->get_buffer_length_(), STREAM_GRAY_HIGH);
+  } else {
+    this->write_lut_(this->get_lut_(true, FULL_LUT));
+    this->write_buffer_(WRITE_BUFFER, window);
+    this->write_buffer_(WRITE_BASE, window);
+    if (this->full_update_every_ > 1)
+      this->store_old_buffer_();
+  }
   SEND(ON_FULL);
   this->command(ACTIVATE);  // don't wait here
+  this->time_refresh_(true);
   this->is_busy_ = false;
 }
 
 void WaveshareEPaper2P13InV3::display() {
-  if (this->is_busy_ || (this->busy_pin_ != nullptr && this->busy_pin_->digital_read()))
+  if (this->is_busy_ || (this->busy_pin_ != nullptr && this->busy_pin_->digital_read())) {
+    this->discard_frame_hash_();
     return;
+  }
   this->is_busy_ = true;
-  const bool partial = this->at_update_ != 0;
+  // there is no partial grayscale waveform
+  const bool partial = this->at_update_ != 0 && !this->grayscale_;
   this->at_update_ = (this->at_update_ + 1) % this->full_update_every_;
   if (partial) {
     this->partial_update_();
@@ -177,6 +222,8 @@ uint32_t WaveshareEPaper2P13InV3::idle_timeout_() { return 5000; }
 void WaveshareEPaper2P13InV3::dump_config() {
   LOG_DISPLAY("", "Waveshare E-Paper", this);
   ESP_LOGCONFIG(TAG, "  Model: 2.13inV3");
+  if (this->grayscale_)
+    ESP_LOGCONFIG(TAG, "  Grayscale: 4 levels");
   LOG_PIN("  CS Pin: ", this->cs_);
   LOG_PIN("  Reset Pin: ", this->reset_pin_);
   LOG_PIN("  DC Pin: ", this->dc_pin_);
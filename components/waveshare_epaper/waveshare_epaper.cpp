@@ -1,7 +1,10 @@
 #include "waveshare_epaper.h"
+#include <algorithm>
 #include <bitset>
 #include <cinttypes>
+#include <cmath>
 #include "esphome/core/application.h"
+#include "esphome/core/hal.h"
 #include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
 
@@ -10,6 +13,9 @@ namespace waveshare_epaper {
 
 static const char *const TAG = "waveshare_epaper";
 
+// size of the bounce buffer used by write_stream_(), a multiple of the word size
+static const uint32_t STREAM_CHUNK_SIZE = 128;
+
 static const uint8_t LUT_SIZE_WAVESHARE = 30;
 
 static const uint8_t FULL_UPDATE_LUT[LUT_SIZE_WAVESHARE] = {0x02, 0x02, 0x01, 0x11, 0x12, 0x12, 0x22, 0x22, 0x66, 0x69,
@@ -20,6 +26,27 @@ static const uint8_t PARTIAL_UPDATE_LUT[LUT_SIZE_WAVESHARE] = {
     0x10, 0x18, 0x18, 0x08, 0x18, 0x18, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
     0x00, 0x00, 0x00, 0x00, 0x00, 0x13, 0x14, 0x44, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 
+const uint8_t WaveshareEPaper::SSD1680_GRAYSCALE_LUT[SSD1680_LUT_SIZE] = {
+    0x00, 0x60, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // VS L0
+    0x20, 0x60, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // VS L1
+    0x28, 0x60, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // VS L2
+    0x2A, 0x60, 0x15, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // VS L3
+    0x00, 0x90, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // VS L4
+    0x00, 0x02, 0x00, 0x05, 0x14, 0x00, 0x00,                                // TP, SR, RP of group 0
+    0x1E, 0x1E, 0x00, 0x00, 0x00, 0x00, 0x01,                                // TP, SR, RP of group 1
+    0x00, 0x02, 0x00, 0x05, 0x14, 0x00, 0x00,                                // TP, SR, RP of group 2
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,                                // TP, SR, RP of group 3
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,                                // TP, SR, RP of group 4
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,                                // TP, SR, RP of group 5
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,                                // TP, SR, RP of group 6
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,                                // TP, SR, RP of group 7
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,                                // TP, SR, RP of group 8
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,                                // TP, SR, RP of group 9
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,                                // TP, SR, RP of group 10
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,                                // TP, SR, RP of group 11
+    0x24, 0x22, 0x22, 0x22, 0x23, 0x32, 0x00, 0x00, 0x00,                    // FR, XON
+};
+
 static const uint8_t LUT_SIZE_TTGO = 70;
 
 static const uint8_t FULL_UPDATE_LUT_TTGO[LUT_SIZE_TTGO] = {
@@ -111,13 +138,60 @@ static const uint8_t PARTIAL_UPD_2IN9_LUT[PARTIAL_UPD_2IN9_LUT_SIZE] =
 };
 // clang-format on
 
+// the compressed buffer is cached and encoded in bands of this many lines
+static const uint32_t COMPRESSED_BAND_LINES = 8;
+
+void WaveshareEPaperBase::init_geometry_() {
+  this->width_internal_ = this->get_width_internal();
+  this->height_internal_ = this->get_height_internal();
+  this->width_controller_ = this->get_width_controller();
+  this->buffer_length_ = this->get_buffer_length_();
+}
 void WaveshareEPaperBase::setup() {
-  this->init_internal_(this->get_buffer_length_());
+  this->init_geometry_();
+  if (this->use_compressed_buffer_) {
+    this->init_compressed_buffer_(1);
+  } else {
+    this->init_internal_(this->get_buffer_length_());
+  }
   this->setup_pins_();
   this->spi_setup();
   this->reset_();
   this->initialize();
 }
+bool WaveshareEPaperBase::init_compressed_buffer_(uint8_t unit_size) {
+  const uint32_t length = this->get_buffer_length_();
+  const uint32_t line_length = length / this->get_height_internal();
+  this->compressed_buffer_ = new CompressedBuffer();  // NOLINT(cppcoreguidelines-owning-memory)
+  if (!this->compressed_buffer_->init(length, line_length * COMPRESSED_BAND_LINES, unit_size)) {
+    ESP_LOGE(TAG, "Could not allocate compressed buffer for display!");
+    delete this->compressed_buffer_;  // NOLINT(cppcoreguidelines-owning-memory)
+    this->compressed_buffer_ = nullptr;
+    this->mark_failed();
+    return false;
+  }
+  this->clear();
+  return true;
+}
+bool WaveshareEPaperBase::init_old_buffer_(uint8_t value) {
+  RAMAllocator<uint8_t> allocator;
+  this->old_buffer_ = allocator.allocate(this->get_buffer_length_());
+  if (this->old_buffer_ == nullptr) {
+    ESP_LOGE(TAG, "Could not allocate old buffer for display!");
+    return false;
+  }
+  memset(this->old_buffer_, value, this->get_buffer_length_());
+  return true;
+}
+void WaveshareEPaperBase::store_old_buffer_() {
+  if (this->old_buffer_ == nullptr && !this->init_old_buffer_(0x00))
+    return;
+  if (this->auto_clear_enabled_) {
+    std::swap(this->buffer_, this->old_buffer_);
+  } else {
+    memcpy(this->old_buffer_, this->buffer_, this->get_buffer_length_());
+  }
+}
 void WaveshareEPaperBase::setup_pins_() {
   this->dc_pin_->setup();  // OUTPUT
   this->dc_pin_->digital_write(false);
@@ -135,6 +209,7 @@ void WaveshareEPaperBase::setup_pins_() {
 }
 float WaveshareEPaperBase::get_setup_priority() const { return setup_priority::PROCESSOR; }
 void WaveshareEPaperBase::command(uint8_t value) {
+  ESP_LOGVV(TAG, "Command 0x%02X", value);
   this->start_command_();
   this->write_byte(value);
   this->end_command_();
@@ -148,6 +223,9 @@ void WaveshareEPaperBase::data(uint8_t value) {
 // write a command followed by one or more bytes of data.
 // The command is the first byte, length is the total including cmd.
 void WaveshareEPaperBase::cmd_data(const uint8_t *c_data, size_t length) {
+  ESP_LOGVV(TAG, "Command 0x%02X with %u data bytes", c_data[0], (unsigned) (length - 1));
+  this->spi_stats_.commands++;
+  this->spi_stats_.transactions++;
   this->dc_pin_->digital_write(false);
   this->enable();
   this->write_byte(c_data[0]);
@@ -165,30 +243,443 @@ bool WaveshareEPaperBase::wait_until_idle_() {
   while (this->busy_pin_->digital_read()) {
     if (millis() - start > this->idle_timeout_()) {
       ESP_LOGE(TAG, "Timeout while displaying image!");
+      this->spi_stats_.busy_time += millis() - start;
       return false;
     }
     delay(1);
   }
+  this->spi_stats_.busy_time += millis() - start;
   return true;
 }
+void WaveshareEPaperBase::wait_until_idle_async_(std::function<void()> &&on_idle, uint32_t settle_time) {
+  this->on_idle_ = std::move(on_idle);
+  this->busy_wait_start_ = millis();
+  this->busy_wait_settle_time_ = settle_time;
+  this->refresh_pending_ = true;
+  this->set_interval("busy_wait", 10, [this]() { this->poll_busy_(); });
+}
+void WaveshareEPaperBase::poll_busy_() {
+  if (!this->is_idle_()) {
+    if (millis() - this->busy_wait_start_ <= this->idle_timeout_())
+      return;
+    ESP_LOGE(TAG, "Timeout while displaying image!");
+  }
+  this->cancel_interval("busy_wait");
+  this->spi_stats_.busy_time += millis() - this->busy_wait_start_;
+  ESP_LOGV(TAG, "Controller idle after %" PRIu32 " ms", millis() - this->busy_wait_start_);
+
+  // the callback may start the next asynchronous wait right away
+  auto finish = [this]() {
+    this->refresh_pending_ = false;
+    auto on_idle = std::move(this->on_idle_);
+    this->on_idle_ = nullptr;
+    if (on_idle)
+      on_idle();
+  };
+  if (this->busy_wait_settle_time_ > 0) {
+    this->set_timeout("busy_wait", this->busy_wait_settle_time_, finish);
+  } else {
+    finish();
+  }
+}
+void WaveshareEPaperBase::run_sequence_(const uint8_t *sequence, uint8_t flags) {
+  this->run_sequence_part_(sequence, flags, true);
+}
+void WaveshareEPaperBase::run_sequence_async_(const uint8_t *sequence, uint8_t flags,
+                                              std::function<void()> &&on_done) {
+  const uint8_t *wait = this->run_sequence_part_(sequence, flags, false);
+  if (wait == nullptr) {
+    if (on_done)
+      on_done();
+    return;
+  }
+  if (progmem_read_byte(wait) == SEQ_WAIT_IDLE) {
+    this->wait_until_idle_async_(
+        [this, wait, flags, on_done]() mutable { this->run_sequence_async_(wait + 1, flags, std::move(on_done)); });
+    return;
+  }
+  // SEQ_DELAY
+  this->refresh_pending_ = true;
+  this->set_timeout("sequence", progmem_read_byte(wait + 1), [this, wait, flags, on_done]() mutable {
+    this->refresh_pending_ = false;
+    this->run_sequence_async_(wait + 2, flags, std::move(on_done));
+  });
+}
+const uint8_t *WaveshareEPaperBase::run_sequence_part_(const uint8_t *sequence, uint8_t flags, bool blocking) {
+  uint8_t data[SEQ_MAX_DATA];
+  bool selected = false;
+  const uint8_t *pos = sequence;
+  while (true) {
+    const uint8_t op = progmem_read_byte(pos);
+    if (op <= SEQ_CMD + SEQ_MAX_DATA) {
+      const uint8_t length = op - SEQ_CMD;
+      const uint8_t command = progmem_read_byte(pos + 1);
+      ESP_LOGVV(TAG, "Command 0x%02X with %u data bytes", command, length);
+      // the controllers sample D/C with the last bit of every byte, so CS can stay asserted between commands
+      if (!selected) {
+        this->enable();
+        this->spi_stats_.transactions++;
+        selected = true;
+      }
+      this->spi_stats_.commands++;
+      this->dc_pin_->digital_write(false);
+      this->write_byte(command);
+      if (length > 0) {
+        for (uint8_t i = 0; i < length; i++)
+          data[i] = progmem_read_byte(pos + 2 + i);
+        this->dc_pin_->digital_write(true);
+        this->write_array(data, length);
+      }
+      pos += 2 + length;
+      continue;
+    }
+
+    if (selected) {
+      this->disable();
+      selected = false;
+    }
+    switch (op) {
+      case SEQ_DELAY:
+        if (!blocking)
+          return pos;
+        delay(progmem_read_byte(pos + 1));  // NOLINT
+        pos += 2;
+        break;
+      case SEQ_WAIT_IDLE:
+        if (!blocking)
+          return pos;
+        this->wait_until_idle_();
+        pos += 1;
+        break;
+      case SEQ_SKIP_IF:
+      case SEQ_SKIP_UNLESS: {
+        const bool set = (flags & progmem_read_byte(pos + 1)) != 0;
+        const uint8_t skip = progmem_read_byte(pos + 2);
+        pos += 3;
+        if (set == (op == SEQ_SKIP_IF))
+          pos += skip;
+        break;
+      }
+      case SEQ_END:
+        return nullptr;
+      default:
+        ESP_LOGE(TAG, "Invalid sequence opcode 0x%02X at offset %u", op, (unsigned) (pos - sequence));
+        return nullptr;
+    }
+  }
+}
 void WaveshareEPaperBase::update() {
-  this->do_update_();
+  if (this->refresh_pending_) {
+    ESP_LOGD(TAG, "Previous refresh still in progress, skipping update");
+    return;
+  }
+  this->render_frame_(0, this->get_buffer_length_());
+  if (this->skip_unchanged_ && this->frame_unchanged_(this->get_frame_hash_()))
+    return;
+  const SPIStats since = this->spi_stats_;
+  const uint32_t start = millis();
   this->display();
+  this->log_spi_stats_(since, start);
+}
+void WaveshareEPaperBase::log_spi_stats_(const SPIStats &since, uint32_t start) {
+  // busy waits continuing in the background are only included once they finished
+  ESP_LOGD(TAG,
+           "Frame sent in %" PRIu32 " ms: %" PRIu32 " commands, %" PRIu32 " transactions, %" PRIu32
+           " bytes, %" PRIu32 " ms busy",
+           millis() - start, this->spi_stats_.commands - since.commands,
+           this->spi_stats_.transactions - since.transactions, this->spi_stats_.bytes - since.bytes,
+           this->spi_stats_.busy_time - since.busy_time);
+}
+void WaveshareEPaperBase::render_frame_(uint32_t offset, uint32_t length) {
+  if (!this->static_layer_) {
+    this->do_update_();
+    return;
+  }
+
+  if (this->static_buffer_ == nullptr && !this->static_layer_valid_) {
+    RAMAllocator<uint8_t> allocator;
+    this->static_buffer_ = allocator.allocate(this->get_buffer_length_());
+    if (this->static_buffer_ == nullptr) {
+      ESP_LOGW(TAG, "Could not allocate the static layer, drawing it with every frame");
+      this->static_layer_valid_ = true;
+    }
+  }
+
+  if (this->static_buffer_ == nullptr) {
+    this->clear();
+    this->static_layer_(*this);
+  } else if (!this->static_layer_valid_) {
+    const uint32_t start = millis();
+    this->clear();
+    this->static_layer_(*this);
+    this->copy_static_layer_(true, offset, length);
+    ESP_LOGD(TAG, "Static layer drawn in %" PRIu32 " ms", millis() - start);
+    // banded models complete the layer with their last band
+    this->static_layer_valid_ = offset + length >= this->get_buffer_length_();
+  } else {
+    this->copy_static_layer_(false, offset, length);
+  }
+
+  // clearing would drop the static layer
+  const bool auto_clear = this->auto_clear_enabled_;
+  this->auto_clear_enabled_ = false;
+  this->do_update_();
+  this->auto_clear_enabled_ = auto_clear;
+}
+void WaveshareEPaperBase::copy_static_layer_(bool save, uint32_t offset, uint32_t length) {
+  if (save) {
+    memcpy(this->static_buffer_ + offset, this->buffer_, length);
+  } else {
+    memcpy(this->buffer_, this->static_buffer_ + offset, length);
+  }
+}
+void WaveshareEPaperBase::power_up_() {
+  const uint32_t now = millis();
+  if (this->last_power_up_ == 0) {
+    // start from the configured interval, an update interval of never makes the controller sleep
+    this->update_interval_ = this->get_update_interval();
+  } else {
+    // smooth out irregular intervals, e.g. from skipped frames or manual updates
+    this->update_interval_ = (this->update_interval_ / 4) * 3 + (now - this->last_power_up_) / 4;
+  }
+  this->last_power_up_ = now;
+
+  this->account_power_state_();
+  if (this->power_state_ == POWER_STATE_ON)
+    return;
+  const PowerState from = this->power_state_;
+  this->set_power_state_(POWER_STATE_ON);
+  this->power_state_ = POWER_STATE_ON;
+  this->wake_time_[from] = millis() - now;
+  ESP_LOGD(TAG, "Woke up from %s in %" PRIu32 " ms", from == POWER_STATE_SLEEP ? "deep sleep" : "power off",
+           this->wake_time_[from]);
+}
+void WaveshareEPaperBase::power_down_() {
+  this->account_power_state_();
+  const PowerState state = this->choose_power_state_();
+  if (state != this->power_state_ && this->set_power_state_(state))
+    this->power_state_ = state;
+}
+PowerState WaveshareEPaperBase::choose_power_state_() {
+  switch (this->power_mode_) {
+    case POWER_MODE_ALWAYS_ON:
+      return POWER_STATE_ON;
+    case POWER_MODE_POWER_OFF:
+      return POWER_STATE_OFF;
+    case POWER_MODE_DEEP_SLEEP:
+      return POWER_STATE_SLEEP;
+    default:
+      break;
+  }
+
+  // charge in mAs until the next frame for each state, waking up is assumed to draw the on current. An unknown wake
+  // up time counts as free, so the lower states get tried and measured.
+  const uint32_t elapsed = millis() - this->last_power_up_;
+  const float idle = this->update_interval_ > elapsed ? (this->update_interval_ - elapsed) / 1000.0f : 0.0f;
+  const float wake_current = this->state_current_[POWER_STATE_ON];
+  PowerState best = POWER_STATE_ON;
+  float best_charge = idle * this->state_current_[POWER_STATE_ON];
+  for (PowerState state : {POWER_STATE_OFF, POWER_STATE_SLEEP}) {
+    const float charge = idle * this->state_current_[state] + this->wake_time_[state] / 1000.0f * wake_current;
+    if (charge < best_charge) {
+      best = state;
+      best_charge = charge;
+    }
+  }
+  return best;
+}
+void WaveshareEPaperBase::account_power_state_() {
+  const uint32_t now = millis();
+  const uint32_t elapsed = now - this->power_state_start_;
+  this->charge_ += this->state_current_[this->power_state_] * (elapsed / 1000.0f);
+  this->charge_time_ += elapsed;
+  this->power_state_start_ = now;
+#ifdef USE_SENSOR
+  if (this->average_current_sensor_ != nullptr && this->charge_time_ > 0)
+    this->average_current_sensor_->publish_state(this->charge_ * 1000.0f / this->charge_time_);
+  if (this->charge_sensor_ != nullptr)
+    this->charge_sensor_->publish_state(this->charge_ / 3600.0f);
+#endif
+}
+void WaveshareEPaperBase::dump_power_config_() {
+  static const char *const MODES[] = {"auto", "always on", "power off", "deep sleep"};
+  ESP_LOGCONFIG(TAG,
+                "  Power Mode: %s\n"
+                "  State Currents: on %.3f mA, off %.3f mA, sleep %.3f mA",
+                MODES[this->power_mode_], this->state_current_[POWER_STATE_ON], this->state_current_[POWER_STATE_OFF],
+                this->state_current_[POWER_STATE_SLEEP]);
+#ifdef USE_SENSOR
+  LOG_SENSOR("  ", "Average Current", this->average_current_sensor_);
+  LOG_SENSOR("  ", "Charge", this->charge_sensor_);
+#endif
+}
+uint32_t WaveshareEPaperBase::get_frame_hash_() {
+  if (this->compressed_buffer_ == nullptr)
+    return this->buffer_ == nullptr ? 0 : hash_buffer_(this->buffer_, this->get_buffer_length_());
+
+  // the chunks depend on the encoding, so hash byte by byte
+  uint32_t hash = 2166136261UL;
+  this->compressed_buffer_->stream([&hash](const uint8_t *data, size_t length) {
+    for (size_t i = 0; i < length; i++)
+      hash = (hash ^ data[i]) * 16777619UL;
+  });
+  return hash;
+}
+bool WaveshareEPaperBase::frame_unchanged_(uint32_t hash) {
+  if (this->frame_hash_valid_ && hash == this->frame_hash_) {
+    this->skipped_updates_++;
+    ESP_LOGD(TAG, "Frame unchanged, skipping refresh (%" PRIu32 " updates skipped)", this->skipped_updates_);
+    return true;
+  }
+  this->frame_hash_ = hash;
+  this->frame_hash_valid_ = true;
+  return false;
 }
 void WaveshareEPaper::fill(Color color) {
-  // If clipping is active, fall back to base implementation
+  // flip logic
+  uint8_t fill = color.is_on() ? 0x00 : 0xFF;
+  if (this->grayscale_)
+    fill = 0x55 * this->get_gray_level_(color);
+
+  // a clipped area is a rectangle on the panel in every rotation as well
   if (this->get_clipping().is_set()) {
-    Display::fill(color);
+    const display::Rect rect = this->get_physical_rect_(this->get_clipping());
+    for (int y = rect.y; y < rect.y + rect.h; y++)
+      this->write_span_(rect.x, rect.x + rect.w, y, fill);
     return;
   }
 
-  // flip logic
-  const uint8_t fill = color.is_on() ? 0x00 : 0xFF;
+  if (this->compressed_buffer_ != nullptr) {
+    this->compressed_buffer_->fill(&fill);
+    return;
+  }
   for (uint32_t i = 0; i < this->get_buffer_length_(); i++)
     this->buffer_[i] = fill;
 }
+void HOT WaveshareEPaper::write_span_(int x_start, int x_end, int y, uint8_t pattern) {
+  if (x_start >= x_end)
+    return;
+
+  // pixels per byte as a shift
+  const uint8_t pixel_shift = this->grayscale_ ? 2 : 3;
+  const uint8_t bits_shift = 3 - pixel_shift;
+  const uint8_t pixel_mask = (1 << pixel_shift) - 1;
+  const uint32_t line = y * (this->width_controller_ >> pixel_shift);
+  uint32_t first = line + (x_start >> pixel_shift);
+  const uint32_t last = line + ((x_end - 1) >> pixel_shift);
+  const uint8_t first_mask = 0xFF >> ((x_start & pixel_mask) << bits_shift);
+  const uint8_t last_mask = 0xFF << ((pixel_mask - ((x_end - 1) & pixel_mask)) << bits_shift);
+  auto merge = [this, pattern](uint32_t pos, uint8_t mask) {
+    uint8_t *byte = this->compressed_buffer_ != nullptr ? this->compressed_buffer_->get(pos) : this->buffer_ + pos;
+    *byte = (*byte & ~mask) | (pattern & mask);
+  };
+  if (first == last) {
+    merge(first, first_mask & last_mask);
+    return;
+  }
+
+  merge(first++, first_mask);
+  if (this->compressed_buffer_ != nullptr) {
+    for (; first < last; first++)
+      *this->compressed_buffer_->get(first) = pattern;
+  } else {
+    memset(this->buffer_ + first, pattern, last - first);
+  }
+  merge(last, last_mask);
+}
+void HOT WaveshareEPaper::draw_pixels_at(int x_start, int y_start, int w, int h, const uint8_t *ptr,
+                                         display::ColorOrder order, display::ColorBitness bitness, bool big_endian,
+                                         int x_offset, int y_offset, int x_pad) {
+  if (this->grayscale_ || this->compressed_buffer_ != nullptr) {
+    Display::draw_pixels_at(x_start, y_start, w, h, ptr, order, bitness, big_endian, x_offset, y_offset, x_pad);
+    return;
+  }
+
+  // clip in display coordinates
+  int x_begin = std::max(x_start, 0);
+  int x_end = std::min(x_start + w, this->get_width());
+  int y_begin = std::max(y_start, 0);
+  int y_end = std::min(y_start + h, this->get_height());
+  display::Rect clip = this->get_clipping();
+  if (clip.is_set()) {
+    x_begin = std::max<int>(x_begin, clip.x);
+    x_end = std::min<int>(x_end, clip.x2());
+    y_begin = std::max<int>(y_begin, clip.y);
+    y_end = std::min<int>(y_end, clip.y2());
+  }
+  if (x_begin >= x_end || y_begin >= y_end)
+    return;
+
+  // a source row runs along a panel row for 0 and 180 degrees, down or up a panel column for 90 and 270 degrees
+  const int stride = this->width_controller_ / 8;
+  const bool along_row =
+      this->rotation_ == display::DISPLAY_ROTATION_0_DEGREES || this->rotation_ == display::DISPLAY_ROTATION_180_DEGREES;
+  const bool forward =
+      this->rotation_ == display::DISPLAY_ROTATION_0_DEGREES || this->rotation_ == display::DISPLAY_ROTATION_90_DEGREES;
+  const size_t pixel_size =
+      bitness == display::COLOR_BITNESS_888 ? 3 : (bitness == display::COLOR_BITNESS_565 ? 2 : 1);
+  const size_t line_stride = (x_offset + w + x_pad) * pixel_size;
+  for (int y = y_begin; y < y_end; y++) {
+    const uint8_t *src = ptr + (y_offset + y - y_start) * line_stride + (x_offset + x_begin - x_start) * pixel_size;
+    int px, py;
+    switch (this->rotation_) {
+      case display::DISPLAY_ROTATION_90_DEGREES:
+        px = this->width_internal_ - y - 1;
+        py = x_begin;
+        break;
+      case display::DISPLAY_ROTATION_180_DEGREES:
+        px = this->width_internal_ - x_begin - 1;
+        py = this->height_internal_ - y - 1;
+        break;
+      case display::DISPLAY_ROTATION_270_DEGREES:
+        px = y;
+        py = this->height_internal_ - x_begin - 1;
+        break;
+      default:
+        px = x_begin;
+        py = y;
+        break;
+    }
+    uint32_t pos = py * stride + px / 8;
+    uint8_t mask = 0x80 >> (px & 0x07);
+    for (int x = x_begin; x < x_end; x++, src += pixel_size) {
+      // any set bit is a coloured pixel, whatever the channel order
+      bool on = src[0] != 0;
+      for (size_t i = 1; i < pixel_size; i++)
+        on |= src[i] != 0;
+      // flip logic
+      if (on) {
+        this->buffer_[pos] &= ~mask;
+      } else {
+        this->buffer_[pos] |= mask;
+      }
+
+      if (!along_row) {
+        pos = forward ? pos + stride : pos - stride;
+      } else if (forward) {
+        mask >>= 1;
+        if (mask == 0) {
+          mask = 0x80;
+          pos++;
+        }
+      } else {
+        mask <<= 1;
+        if (mask == 0) {
+          mask = 0x01;
+          pos--;
+        }
+      }
+    }
+  }
+}
 void WaveshareEPaper7C::setup() {
-  this->init_internal_7c_(this->get_buffer_length_());
+  this->init_geometry_();
+  if (this->use_compressed_buffer_) {
+    // 8 pixels are packed into 3 bytes
+    this->init_compressed_buffer_(3);
+  } else {
+    this->init_internal_7c_(this->get_buffer_length_());
+  }
   this->setup_pins_();
   this->spi_setup();
   this->reset_();
@@ -257,52 +748,98 @@ void WaveshareEPaper7C::fill(Color color) {
     pixel_color = 0x1;
   }
 
-  if (this->buffers_[0] == nullptr) {
+  // We store 8 bitset<3> in 3 bytes
+  // | byte 1 | byte 2 | byte 3 |
+  // |aaabbbaa|abbbaaab|bbaaabbb|
+  const uint8_t packed[3] = {
+      (uint8_t) (pixel_color << 5 | pixel_color << 2 | pixel_color >> 1),
+      (uint8_t) (pixel_color << 7 | pixel_color << 4 | pixel_color << 1 | pixel_color >> 2),
+      (uint8_t) (pixel_color << 6 | pixel_color << 3 | pixel_color << 0),
+  };
+
+  if (!this->buffers_available_()) {
     ESP_LOGE(TAG, "Buffer unavailable!");
+  } else if (this->compressed_buffer_ != nullptr) {
+    this->compressed_buffer_->fill(packed);
   } else {
     uint32_t small_buffer_length = this->get_buffer_length_() / NUM_BUFFERS;
     for (auto &buffer : this->buffers_) {
       for (uint32_t buffer_pos = 0; buffer_pos < small_buffer_length; buffer_pos += 3) {
-        // We store 8 bitset<3> in 3 bytes
-        // | byte 1 | byte 2 | byte 3 |
-        // |aaabbbaa|abbbaaab|bbaaabbb|
-        buffer[buffer_pos + 0] = pixel_color << 5 | pixel_color << 2 | pixel_color >> 1;
-        buffer[buffer_pos + 1] = pixel_color << 7 | pixel_color << 4 | pixel_color << 1 | pixel_color >> 2;
-        buffer[buffer_pos + 2] = pixel_color << 6 | pixel_color << 3 | pixel_color << 0;
+        buffer[buffer_pos + 0] = packed[0];
+        buffer[buffer_pos + 1] = packed[1];
+        buffer[buffer_pos + 2] = packed[2];
       }
       App.feed_wdt();
     }
   }
 }
+uint32_t WaveshareEPaper7C::get_frame_hash_() {
+  if (!this->buffers_available_())
+    return 0;
+  if (this->compressed_buffer_ != nullptr)
+    return WaveshareEPaperBase::get_frame_hash_();
+
+  uint32_t hash = 2166136261UL;
+  const uint32_t small_buffer_length = this->get_buffer_length_() / NUM_BUFFERS;
+  for (auto &buffer : this->buffers_)
+    hash = hash_buffer_(buffer, small_buffer_length, hash);
+  return hash;
+}
+void WaveshareEPaper7C::copy_static_layer_(bool save, uint32_t offset, uint32_t length) {
+  if (!this->buffers_available_())
+    return;
+  // the frame is split over the small buffers, the whole frame is always copied
+  const uint32_t small_buffer_length = this->get_buffer_length_() / NUM_BUFFERS;
+  for (int i = 0; i < NUM_BUFFERS; i++) {
+    uint8_t *layer = this->static_buffer_ + i * small_buffer_length;
+    if (save) {
+      memcpy(layer, this->buffers_[i], small_buffer_length);
+    } else {
+      memcpy(this->buffers_[i], layer, small_buffer_length);
+    }
+  }
+}
 void WaveshareEPaper7C::send_buffers_() {
-  if (this->buffers_[0] == nullptr) {
+  if (!this->buffers_available_()) {
     ESP_LOGE(TAG, "Buffer unavailable!");
     return;
   }
 
-  uint32_t small_buffer_length = this->get_buffer_length_() / NUM_BUFFERS;
-  uint8_t byte_to_send;
-  for (auto &buffer : this->buffers_) {
-    for (uint32_t buffer_pos = 0; buffer_pos < small_buffer_length; buffer_pos += 3) {
-      std::bitset<24> triplet =
-          buffer[buffer_pos + 0] << 16 | buffer[buffer_pos + 1] << 8 | buffer[buffer_pos + 2] << 0;
-      // 8 bitset<3> are stored in 3 bytes
-      // |aaabbbaa|abbbaaab|bbaaabbb|
-      // | byte 1 | byte 2 | byte 3 |
-      byte_to_send = ((triplet >> 17).to_ulong() & 0b01110000) | ((triplet >> 18).to_ulong() & 0b00000111);
-      this->data(byte_to_send);
-
-      byte_to_send = ((triplet >> 11).to_ulong() & 0b01110000) | ((triplet >> 12).to_ulong() & 0b00000111);
-      this->data(byte_to_send);
-
-      byte_to_send = ((triplet >> 5).to_ulong() & 0b01110000) | ((triplet >> 6).to_ulong() & 0b00000111);
-      this->data(byte_to_send);
-
-      byte_to_send = ((triplet << 1).to_ulong() & 0b01110000) | ((triplet << 0).to_ulong() & 0b00000111);
-      this->data(byte_to_send);
+  const uint32_t start = micros();
+  this->start_data_();
+  if (this->compressed_buffer_ != nullptr) {
+    this->compressed_buffer_->stream([this](const uint8_t *data, size_t length) { this->send_packed_(data, length); });
+    ESP_LOGD(TAG, "Compressed buffer size: %" PRIu32 " bytes", this->compressed_buffer_->get_compressed_size());
+  } else {
+    uint32_t small_buffer_length = this->get_buffer_length_() / NUM_BUFFERS;
+    for (auto &buffer : this->buffers_) {
+      this->send_packed_(buffer, small_buffer_length);
+      App.feed_wdt();
+    }
+  }
+  this->end_data_();
+  ESP_LOGV(TAG, "Sent frame in %" PRIu32 " us", micros() - start);
+}
+void HOT WaveshareEPaper7C::send_packed_(const uint8_t *data, uint32_t length) {
+  // every 3 bytes of the buffer become 4 bytes on the wire
+  uint8_t chunk[STREAM_CHUNK_SIZE];
+  uint32_t chunk_length = 0;
+  for (uint32_t buffer_pos = 0; buffer_pos < length; buffer_pos += 3) {
+    std::bitset<24> triplet = data[buffer_pos + 0] << 16 | data[buffer_pos + 1] << 8 | data[buffer_pos + 2] << 0;
+    // 8 bitset<3> are stored in 3 bytes
+    // |aaabbbaa|abbbaaab|bbaaabbb|
+    // | byte 1 | byte 2 | byte 3 |
+    chunk[chunk_length++] = ((triplet >> 17).to_ulong() & 0b01110000) | ((triplet >> 18).to_ulong() & 0b00000111);
+    chunk[chunk_length++] = ((triplet >> 11).to_ulong() & 0b01110000) | ((triplet >> 12).to_ulong() & 0b00000111);
+    chunk[chunk_length++] = ((triplet >> 5).to_ulong() & 0b01110000) | ((triplet >> 6).to_ulong() & 0b00000111);
+    chunk[chunk_length++] = ((triplet << 1).to_ulong() & 0b01110000) | ((triplet << 0).to_ulong() & 0b00000111);
+    if (chunk_length == STREAM_CHUNK_SIZE) {
+      this->write_array(chunk, chunk_length);
+      chunk_length = 0;
     }
-    App.feed_wdt();
   }
+  if (chunk_length > 0)
+    this->write_array(chunk, chunk_length);
 }
 void WaveshareEPaper7C::reset_() {
   if (this->reset_pin_ != nullptr) {
@@ -316,22 +853,177 @@ void WaveshareEPaper7C::reset_() {
 }
 
 void HOT WaveshareEPaper::draw_absolute_pixel_internal(int x, int y, Color color) {
-  if (x >= this->get_width_internal() || y >= this->get_height_internal() || x < 0 || y < 0)
+  if (x >= this->width_internal_ || y >= this->height_internal_ || x < 0 || y < 0)
+    return;
+
+  if (this->grayscale_) {
+    const uint32_t pos = (x + y * this->width_controller_) / 4u;
+    const uint8_t shift = 6 - (x & 0x03) * 2;
+    this->buffer_[pos] = (this->buffer_[pos] & ~(0x03 << shift)) | (this->get_gray_level_(color) << shift);
     return;
+  }
 
-  const uint32_t pos = (x + y * this->get_width_controller()) / 8u;
+  const uint32_t pos = (x + y * this->width_controller_) / 8u;
   const uint8_t subpos = x & 0x07;
+  uint8_t *byte = this->compressed_buffer_ != nullptr ? this->compressed_buffer_->get(pos) : this->buffer_ + pos;
   // flip logic
   if (!color.is_on()) {
-    this->buffer_[pos] |= 0x80 >> subpos;
+    *byte |= 0x80 >> subpos;
   } else {
-    this->buffer_[pos] &= ~(0x80 >> subpos);
+    *byte &= ~(0x80 >> subpos);
   }
 }
 
 uint32_t WaveshareEPaper::get_buffer_length_() {
-  return this->get_width_controller() * this->get_height_internal() / 8u;
+  return this->get_width_controller() * this->get_height_internal() / (this->grayscale_ ? 4u : 8u);
 }  // just a black buffer
+uint8_t WaveshareEPaper::get_gray_level_(Color color) {
+  // like the binary mode, the colour says how much ink to put down
+  const uint8_t ink = std::max<uint8_t>(color.w, (color.r + color.g + color.b) / 3);
+  return 3 - (ink >> 6);
+}
+WaveshareEPaper::FrameWindow WaveshareEPaper::get_full_window_() {
+  return {0, this->get_height_internal(), 0, this->get_width_controller() / 8};
+}
+bool WaveshareEPaper::get_changed_window_(FrameWindow &window) {
+  window = this->get_full_window_();
+  if (this->old_buffer_ == nullptr)
+    return true;
+
+  const int width_bytes = window.right;
+  int top = window.bottom;
+  int bottom = 0;
+  int left = width_bytes;
+  int right = 0;
+  for (int y = 0; y < window.bottom; y++) {
+    const uint8_t *row = this->buffer_ + y * width_bytes;
+    const uint8_t *old_row = this->old_buffer_ + y * width_bytes;
+    if (memcmp(row, old_row, width_bytes) == 0)
+      continue;
+
+    if (top > y)
+      top = y;
+    bottom = y + 1;
+    // only the bytes outside of the current column band need to be compared
+    int x = 0;
+    while (x < left && row[x] == old_row[x])
+      x++;
+    left = x;
+    x = width_bytes;
+    while (x > right && row[x - 1] == old_row[x - 1])
+      x--;
+    right = x;
+  }
+  if (bottom == 0)
+    return false;
+
+  window = {top, bottom, left, right};
+  const uint32_t sent = (bottom - top) * (right - left);
+  this->partial_bytes_saved_ += this->get_buffer_length_() - sent;
+  ESP_LOGD(TAG, "Changed window: rows %d-%d, bytes %d-%d (%" PRIu32 " bytes, %" PRIu32 " bytes saved so far)", top,
+           bottom - 1, left, right - 1, sent, this->partial_bytes_saved_);
+  return true;
+}
+void WaveshareEPaper::write_window_(const uint8_t *source, const FrameWindow &window, StreamTransform transform) {
+  const int width_bytes = this->get_width_controller() / 8;
+  if (window.left == 0 && window.right == width_bytes) {
+    this->write_stream_(source + window.top * width_bytes, (window.bottom - window.top) * width_bytes, transform);
+    return;
+  }
+  // the controller keeps accepting data between the rows
+  for (int y = window.top; y < window.bottom; y++)
+    this->write_stream_(source + y * width_bytes + window.left, window.right - window.left, transform);
+}
+void WaveshareEPaper::set_partial_window_(const FrameWindow &window, bool wide) {
+  const int x_start = window.left * 8;
+  const int x_end = window.right * 8 - 1;
+  this->command(0x90);
+  if (wide)
+    this->data(x_start >> 8);
+  this->data(x_start & 0xF8);
+  if (wide)
+    this->data(x_end >> 8);
+  this->data(x_end & 0xFF);
+  this->data(window.top >> 8);
+  this->data(window.top & 0xFF);
+  this->data((window.bottom - 1) >> 8);
+  this->data((window.bottom - 1) & 0xFF);
+  this->data(0x01);  // gates scan inside and outside of the window
+}
+bool WaveshareEPaper::use_fast_refresh_() {
+  switch (this->refresh_mode_) {
+    case REFRESH_MODE_FAST:
+      return true;
+    case REFRESH_MODE_NORMAL:
+      return false;
+    default:
+      break;
+  }
+#ifdef USE_SENSOR
+  if (this->temperature_sensor_ != nullptr) {
+    const float temperature = this->temperature_sensor_->state;
+    // without a reading the controller has to measure itself
+    if (std::isnan(temperature))
+      return false;
+    return temperature >= this->fast_refresh_min_temperature_;
+  }
+#endif
+  return this->fast_refresh_default_;
+}
+void WaveshareEPaper::activate_full_refresh_() {
+  if (this->use_fast_refresh_()) {
+    ESP_LOGD(TAG, "Fast refresh");
+    // a forced high temperature selects the fast waveform
+    this->command(0x1A);  // Write to temperature register
+    this->data(0x6E);
+    this->command(0x22);  // Display Update Control, without loading the temperature
+    this->data(0xD7);
+  } else {
+    ESP_LOGD(TAG, "Normal refresh");
+    // the controller measures the temperature and loads the matching waveform, slower ones in the cold
+    this->command(0x22);  // Display Update Control
+    this->data(0xF7);
+  }
+  this->command(0x20);  // Activate Display Update Sequence
+}
+void WaveshareEPaper::dump_refresh_mode_() {
+  const char *mode;
+  switch (this->refresh_mode_) {
+    case REFRESH_MODE_FAST:
+      mode = "fast";
+      break;
+    case REFRESH_MODE_NORMAL:
+      mode = "normal";
+      break;
+    default:
+      mode = "auto";
+      break;
+  }
+  ESP_LOGCONFIG(TAG,
+                "  Refresh Mode: %s\n"
+                "  Fast Refresh Min Temperature: %.1f°C",
+                mode, this->fast_refresh_min_temperature_);
+#ifdef USE_SENSOR
+  LOG_SENSOR("  ", "Temperature Sensor", this->temperature_sensor_);
+#endif
+}
+const uint8_t *WaveshareEPaper::get_lut_(bool full, const uint8_t *builtin) const {
+  const std::vector<uint8_t> &custom = full ? this->full_lut_ : this->partial_lut_;
+  return custom.empty() ? builtin : custom.data();
+}
+bool WaveshareEPaper::lut_needs_load_(const uint8_t *lut) {
+  if (lut == this->loaded_lut_)
+    return false;
+  this->loaded_lut_ = lut;
+  return true;
+}
+void WaveshareEPaper::time_refresh_(bool full) {
+  if (this->busy_pin_ == nullptr)
+    return;
+  const uint32_t start = millis();
+  this->wait_until_idle_async_(
+      [start, full]() { ESP_LOGD(TAG, "%s refresh took %" PRIu32 " ms", full ? "Full" : "Partial", millis() - start); });
+}
 uint32_t WaveshareEPaperBWR::get_buffer_length_() {
   return this->get_width_controller() * this->get_height_internal() / 4u;
 }  // black and red buffer
@@ -339,68 +1031,245 @@ uint32_t WaveshareEPaper7C::get_buffer_length_() {
   return this->get_width_controller() * this->get_height_internal() / 8u * 3u;
 }  // 7 colors buffer, 1 pixel = 3 bits, we will store 8 pixels in 24 bits = 3 bytes
 
+// draw red pixels only, if the color contains red only
+static bool is_red(Color color) { return color.red > 0 && color.green == 0 && color.blue == 0; }
+
 void WaveshareEPaperBWR::fill(Color color) {
-  this->filled_rectangle(0, 0, this->get_width(), this->get_height(), color);
+  const display::Rect rect = this->get_physical_rect_(this->get_clipping());
+  if (rect.x == 0 && rect.y == 0 && rect.w == this->get_width_internal() && rect.h == this->get_height_internal()) {
+    const uint32_t buf_half_len = this->get_buffer_length_() / 2u;
+    memset(this->buffer_, color.is_on() ? 0xFF : 0x00, buf_half_len);
+    memset(this->buffer_ + buf_half_len, is_red(color) ? 0xFF : 0x00, buf_half_len);
+    return;
+  }
+
+  for (int y = rect.y; y < rect.y + rect.h; y++)
+    this->write_span_(rect.x, rect.x + rect.w, y, color);
 }
 void HOT WaveshareEPaperBWR::draw_absolute_pixel_internal(int x, int y, Color color) {
-  if (x >= this->get_width_internal() || y >= this->get_height_internal() || x < 0 || y < 0)
+  const int width = this->width_internal_;
+  if (x >= width || y >= this->height_internal_ || x < 0 || y < 0)
     return;
 
-  const uint32_t buf_half_len = this->get_buffer_length_() / 2u;
-
-  const uint32_t pos = (x + y * this->get_width_internal()) / 8u;
-  const uint8_t subpos = x & 0x07;
+  // both planes are updated with the same position and mask
+  uint8_t *black = this->buffer_ + (x + y * width) / 8u;
+  uint8_t *red = black + this->buffer_length_ / 2u;
+  const uint8_t mask = 0x80 >> (x & 0x07);
   // flip logic
   if (color.is_on()) {
-    this->buffer_[pos] |= 0x80 >> subpos;
+    *black |= mask;
   } else {
-    this->buffer_[pos] &= ~(0x80 >> subpos);
+    *black &= ~mask;
   }
 
-  // draw red pixels only, if the color contains red only
-  if (((color.red > 0) && (color.green == 0) && (color.blue == 0))) {
-    this->buffer_[pos + buf_half_len] |= 0x80 >> subpos;
+  if (is_red(color)) {
+    *red |= mask;
   } else {
-    this->buffer_[pos + buf_half_len] &= ~(0x80 >> subpos);
+    *red &= ~mask;
   }
 }
+void HOT WaveshareEPaperBWR::write_span_(int x_start, int x_end, int y, Color color) {
+  if (x_start >= x_end)
+    return;
+
+  uint8_t *black = this->buffer_ + y * (this->width_internal_ / 8);
+  uint8_t *red = black + this->buffer_length_ / 2u;
+  const uint8_t black_bits = color.is_on() ? 0xFF : 0x00;
+  const uint8_t red_bits = is_red(color) ? 0xFF : 0x00;
+
+  int first = x_start / 8;
+  const int last = (x_end - 1) / 8;
+  const uint8_t first_mask = 0xFF >> (x_start & 0x07);
+  const uint8_t last_mask = 0xFF << (7 - ((x_end - 1) & 0x07));
+  if (first == last) {
+    const uint8_t mask = first_mask & last_mask;
+    black[first] = (black[first] & ~mask) | (black_bits & mask);
+    red[first] = (red[first] & ~mask) | (red_bits & mask);
+    return;
+  }
+
+  black[first] = (black[first] & ~first_mask) | (black_bits & first_mask);
+  red[first] = (red[first] & ~first_mask) | (red_bits & first_mask);
+  first++;
+  memset(black + first, black_bits, last - first);
+  memset(red + first, red_bits, last - first);
+  black[last] = (black[last] & ~last_mask) | (black_bits & last_mask);
+  red[last] = (red[last] & ~last_mask) | (red_bits & last_mask);
+}
+bool WaveshareEPaperBWR::plane_changed_(Plane plane) {
+  const uint32_t buf_half_len = this->get_buffer_length_() / 2u;
+  const uint32_t hash = hash_buffer_(this->buffer_ + plane * buf_half_len, buf_half_len);
+  const bool changed = !this->plane_hash_valid_[plane] || this->plane_hash_[plane] != hash;
+  this->plane_hash_[plane] = hash;
+  this->plane_hash_valid_[plane] = true;
+  return changed;
+}
 void HOT WaveshareEPaper7C::draw_absolute_pixel_internal(int x, int y, Color color) {
-  if (x >= this->get_width_internal() || y >= this->get_height_internal() || x < 0 || y < 0)
+  if (x >= this->width_internal_ || y >= this->height_internal_ || x < 0 || y < 0)
     return;
 
   uint8_t pixel_bits = this->color_to_hex(color);
-  uint32_t small_buffer_length = this->get_buffer_length_() / NUM_BUFFERS;
-  uint32_t pixel_position = x + y * this->get_width_controller();
+  uint32_t small_buffer_length = this->buffer_length_ / NUM_BUFFERS;
+  uint32_t pixel_position = x + y * this->width_controller_;
   uint32_t first_bit_position = pixel_position * 3;
   uint32_t byte_position = first_bit_position / 8u;
   uint32_t byte_subposition = first_bit_position % 8u;
   uint32_t buffer_position = byte_position / small_buffer_length;
   uint32_t buffer_subposition = byte_position % small_buffer_length;
+  // a pixel never crosses a group of 3 bytes, so both bytes are in the same band of the compressed buffer
+  uint8_t *bytes = this->compressed_buffer_ != nullptr ? this->compressed_buffer_->get(byte_position)
+                                                       : this->buffers_[buffer_position] + buffer_subposition;
 
   if (byte_subposition <= 5) {
-    this->buffers_[buffer_position][buffer_subposition] =
-        (this->buffers_[buffer_position][buffer_subposition] & (0xFF ^ (0b111 << (5 - byte_subposition)))) |
-        (pixel_bits << (5 - byte_subposition));
+    bytes[0] = (bytes[0] & (0xFF ^ (0b111 << (5 - byte_subposition)))) | (pixel_bits << (5 - byte_subposition));
   } else {
-    this->buffers_[buffer_position][buffer_subposition + 0] =
-        (this->buffers_[buffer_position][buffer_subposition + 0] & (0xFF ^ (0b111 >> (byte_subposition - 5)))) |
-        (pixel_bits >> (byte_subposition - 5));
+    bytes[0] = (bytes[0] & (0xFF ^ (0b111 >> (byte_subposition - 5)))) | (pixel_bits >> (byte_subposition - 5));
+    bytes[1] = (bytes[1] & (0xFF ^ (0xFF & (0b111 << (13 - byte_subposition))))) |
+               (pixel_bits << (13 - byte_subposition));
+  }
+}
+display::Rect WaveshareEPaperBase::get_physical_rect_(display::Rect rect) {
+  const int width = this->get_width_internal();
+  const int height = this->get_height_internal();
+  if (!rect.is_set())
+    return display::Rect(0, 0, width, height);
+
+  int x, y, w, h;
+  switch (this->rotation_) {
+    case display::DISPLAY_ROTATION_90_DEGREES:
+      x = width - rect.y - rect.h;
+      y = rect.x;
+      w = rect.h;
+      h = rect.w;
+      break;
+    case display::DISPLAY_ROTATION_180_DEGREES:
+      x = width - rect.x - rect.w;
+      y = height - rect.y - rect.h;
+      w = rect.w;
+      h = rect.h;
+      break;
+    case display::DISPLAY_ROTATION_270_DEGREES:
+      x = rect.y;
+      y = height - rect.x - rect.w;
+      w = rect.h;
+      h = rect.w;
+      break;
+    default:
+      x = rect.x;
+      y = rect.y;
+      w = rect.w;
+      h = rect.h;
+      break;
+  }
 
-    this->buffers_[buffer_position][buffer_subposition + 1] = (this->buffers_[buffer_position][buffer_subposition + 1] &
-                                                               (0xFF ^ (0xFF & (0b111 << (13 - byte_subposition))))) |
-                                                              (pixel_bits << (13 - byte_subposition));
+  const int x2 = std::min(x + w, width);
+  const int y2 = std::min(y + h, height);
+  x = std::max(x, 0);
+  y = std::max(y, 0);
+  return display::Rect(x, y, std::max(x2 - x, 0), std::max(y2 - y, 0));
+}
+display::Rect WaveshareEPaperBase::get_logical_rect_(display::Rect rect) {
+  switch (this->rotation_) {
+    case display::DISPLAY_ROTATION_90_DEGREES:
+      return display::Rect(rect.y, this->get_width_internal() - rect.x - rect.w, rect.h, rect.w);
+    case display::DISPLAY_ROTATION_180_DEGREES:
+      return display::Rect(this->get_width_internal() - rect.x - rect.w, this->get_height_internal() - rect.y - rect.h,
+                           rect.w, rect.h);
+    case display::DISPLAY_ROTATION_270_DEGREES:
+      return display::Rect(this->get_height_internal() - rect.y - rect.h, rect.x, rect.h, rect.w);
+    default:
+      return rect;
+  }
+}
+uint32_t WaveshareEPaperBase::hash_buffer_(const uint8_t *data, uint32_t length, uint32_t hash) {
+  uint32_t i = 0;
+  for (; i + 4 <= length; i += 4) {
+    uint32_t word;
+    memcpy(&word, data + i, sizeof(word));
+    hash = (hash ^ word) * 16777619UL;
   }
+  for (; i < length; i++)
+    hash = (hash ^ data[i]) * 16777619UL;
+  return hash;
 }
 void WaveshareEPaperBase::start_command_() {
+  this->spi_stats_.commands++;
+  this->spi_stats_.transactions++;
   this->dc_pin_->digital_write(false);
   this->enable();
 }
 void WaveshareEPaperBase::end_command_() { this->disable(); }
 void WaveshareEPaperBase::start_data_() {
+  this->spi_stats_.transactions++;
   this->dc_pin_->digital_write(true);
   this->enable();
 }
 void WaveshareEPaperBase::end_data_() { this->disable(); }
+void HOT WaveshareEPaperBase::write_stream_(const uint8_t *source, uint32_t length, StreamTransform transform,
+                                            uint8_t fill_value) {
+  const uint32_t start = micros();
+  this->start_data_();
+  if (transform == STREAM_IDENTITY) {
+    this->write_array(source, length);
+  } else if (transform == STREAM_EXPAND) {
+    uint8_t chunk[STREAM_CHUNK_SIZE];
+    uint32_t chunk_length = 0;
+    for (uint32_t pos = 0; pos < length; pos++) {
+      uint8_t eight_pixels = source[pos];
+      for (uint8_t j = 0; j < 4; j++, eight_pixels <<= 2)
+        chunk[chunk_length++] = ((eight_pixels & 0x80) ? 0x30 : 0x00) | ((eight_pixels & 0x40) ? 0x03 : 0x00);
+      if (chunk_length == STREAM_CHUNK_SIZE) {
+        this->write_array(chunk, chunk_length);
+        chunk_length = 0;
+      }
+    }
+    if (chunk_length > 0)
+      this->write_array(chunk, chunk_length);
+  } else if (transform == STREAM_GRAY_HIGH || transform == STREAM_GRAY_LOW) {
+    // gather every other bit of 16 pixels at once, the word is read big endian to keep the first pixel on top
+    const uint8_t shift = transform == STREAM_GRAY_HIGH ? 1 : 0;
+    uint8_t chunk[STREAM_CHUNK_SIZE];
+    uint32_t chunk_length = 0;
+    for (uint32_t pos = 0; pos + 4 <= length; pos += 4) {
+      uint32_t word = encode_uint32(source[pos], source[pos + 1], source[pos + 2], source[pos + 3]);
+      word = (word >> shift) & 0x55555555;
+      word = (word | (word >> 1)) & 0x33333333;
+      word = (word | (word >> 2)) & 0x0F0F0F0F;
+      word = (word | (word >> 4)) & 0x00FF00FF;
+      word = (word | (word >> 8)) & 0x0000FFFF;
+      chunk[chunk_length++] = ~word >> 8;
+      chunk[chunk_length++] = ~word;
+      if (chunk_length == STREAM_CHUNK_SIZE) {
+        this->write_array(chunk, chunk_length);
+        chunk_length = 0;
+      }
+    }
+    if (chunk_length > 0)
+      this->write_array(chunk, chunk_length);
+  } else {
+    uint8_t chunk[STREAM_CHUNK_SIZE];
+    if (transform == STREAM_FILL)
+      memset(chunk, fill_value, std::min(length, STREAM_CHUNK_SIZE));
+    for (uint32_t pos = 0; pos < length; pos += STREAM_CHUNK_SIZE) {
+      const uint32_t chunk_length = std::min(length - pos, STREAM_CHUNK_SIZE);
+      if (transform == STREAM_INVERT) {
+        const uint8_t *in = source + pos;
+        uint32_t i = 0;
+        for (; i + sizeof(uint32_t) <= chunk_length; i += sizeof(uint32_t)) {
+          uint32_t word;
+          memcpy(&word, in + i, sizeof(word));
+          word = ~word;
+          memcpy(chunk + i, &word, sizeof(word));
+        }
+        for (; i < chunk_length; i++)
+          chunk[i] = ~in[i];
+      }
+      this->write_array(chunk, chunk_length);
+    }
+  }
+  this->end_data_();
+  ESP_LOGV(TAG, "Sent %" PRIu32 " bytes in %" PRIu32 " us", length, micros() - start);
+}
 void WaveshareEPaperBase::on_safe_shutdown() { this->deep_sleep(); }
 
 // ========================================================
@@ -427,6 +1296,8 @@ void WaveshareEPaperTypeA::initialize() {
   }
 }
 void WaveshareEPaperTypeA::init_display_() {
+  // called after a reset or wake up, which clear the LUT registers
+  this->invalidate_lut_();
   if (this->model_ == TTGO_EPAPER_2_13_IN_B74 || this->model_ == WAVESHARE_EPAPER_2_13_IN_V2) {
     if (this->reset_pin_ != nullptr) {
       this->reset_pin_->digital_write(false);
@@ -517,6 +1388,8 @@ void WaveshareEPaperTypeA::dump_config() {
       break;
   }
   ESP_LOGCONFIG(TAG, "  Full Update Every: %" PRIu32, this->full_update_every_);
+  if (this->grayscale_)
+    ESP_LOGCONFIG(TAG, "  Grayscale: 4 levels");
   LOG_PIN("  Reset Pin: ", this->reset_pin_);
   LOG_PIN("  DC Pin: ", this->dc_pin_);
   LOG_PIN("  Busy Pin: ", this->busy_pin_);
@@ -524,7 +1397,6 @@ void WaveshareEPaperTypeA::dump_config() {
 }
 void HOT WaveshareEPaperTypeA::display() {
   bool full_update = this->at_update_ == 0;
-  bool prev_full_update = this->at_update_ == 1;
 
   if (this->deep_sleep_between_updates_) {
     ESP_LOGI(TAG, "Wake up the display");
@@ -535,29 +1407,49 @@ void HOT WaveshareEPaperTypeA::display() {
 
   if (!this->wait_until_idle_()) {
     this->status_set_warning();
+    this->discard_frame_hash_();
     return;
   }
 
-  if (this->full_update_every_ >= 1) {
-    if (full_update != prev_full_update) {
-      switch (this->model_) {
-        case TTGO_EPAPER_2_13_IN:
-        case WAVESHARE_EPAPER_2_13_IN_V2:
-          // Waveshare 2.13" V2 uses the same LUTs as TTGO
-          this->write_lut_(full_update ? FULL_UPDATE_LUT_TTGO : PARTIAL_UPDATE_LUT_TTGO, LUT_SIZE_TTGO);
-          break;
-        case TTGO_EPAPER_2_13_IN_B73:
-          this->write_lut_(full_update ? FULL_UPDATE_LUT_TTGO_B73 : PARTIAL_UPDATE_LUT_TTGO_B73, LUT_SIZE_TTGO_B73);
-          break;
-        case TTGO_EPAPER_2_13_IN_B74:
-          // there is no LUT
-          break;
-        case TTGO_EPAPER_2_13_IN_B1:
-          this->write_lut_(full_update ? FULL_UPDATE_LUT_TTGO_B1 : PARTIAL_UPDATE_LUT_TTGO_B1, LUT_SIZE_TTGO_B1);
-          break;
-        default:
-          this->write_lut_(full_update ? FULL_UPDATE_LUT : PARTIAL_UPDATE_LUT, LUT_SIZE_WAVESHARE);
-      }
+  if (this->grayscale_) {
+    // every refresh is a full one with the grayscale waveform
+    full_update = true;
+    this->write_lut_(this->get_lut_(true, SSD1680_GRAYSCALE_LUT), SSD1680_LUT_SIZE);
+    // COMMAND END OPTION, GATE VOLTAGE, SOURCE VOLTAGE, VCOM for the waveform
+    this->command(0x3F);
+    this->data(0x22);
+    this->command(0x03);
+    this->data(0x17);
+    this->command(0x04);
+    this->data(0x41);
+    this->data(0xAE);
+    this->data(0x32);
+    this->command(0x2C);
+    this->data(0x28);
+  } else if (this->full_update_every_ >= 1) {
+    // write_lut_ skips the upload when the table is still loaded
+    switch (this->model_) {
+      case TTGO_EPAPER_2_13_IN:
+      case WAVESHARE_EPAPER_2_13_IN_V2:
+        // Waveshare 2.13" V2 uses the same LUTs as TTGO
+        this->write_lut_(this->get_lut_(full_update, full_update ? FULL_UPDATE_LUT_TTGO : PARTIAL_UPDATE_LUT_TTGO),
+                         LUT_SIZE_TTGO);
+        break;
+      case TTGO_EPAPER_2_13_IN_B73:
+        this->write_lut_(
+            this->get_lut_(full_update, full_update ? FULL_UPDATE_LUT_TTGO_B73 : PARTIAL_UPDATE_LUT_TTGO_B73),
+            LUT_SIZE_TTGO_B73);
+        break;
+      case TTGO_EPAPER_2_13_IN_B74:
+        // there is no LUT
+        break;
+      case TTGO_EPAPER_2_13_IN_B1:
+        this->write_lut_(this->get_lut_(full_update, full_update ? FULL_UPDATE_LUT_TTGO_B1 : PARTIAL_UPDATE_LUT_TTGO_B1),
+                         LUT_SIZE_TTGO_B1);
+        break;
+      default:
+        this->write_lut_(this->get_lut_(full_update, full_update ? FULL_UPDATE_LUT : PARTIAL_UPDATE_LUT),
+                         LUT_SIZE_WAVESHARE);
     }
     this->at_update_ = (this->at_update_ + 1) % this->full_update_every_;
   }
@@ -643,40 +1535,27 @@ void HOT WaveshareEPaperTypeA::display() {
 
   if (!this->wait_until_idle_()) {
     this->status_set_warning();
+    this->discard_frame_hash_();
     return;
   }
 
-  // COMMAND WRITE RAM
-  this->command(0x24);
-  this->start_data_();
-  switch (this->model_) {
-    case TTGO_EPAPER_2_13_IN_B1: {  // block needed because of variable initializations
-      int16_t wb = ((this->get_width_controller()) >> 3);
-      for (int i = 0; i < this->get_height_internal(); i++) {
-        for (int j = 0; j < wb; j++) {
-          int idx = j + (this->get_height_internal() - 1 - i) * wb;
-          this->write_byte(this->buffer_[idx]);
-        }
-      }
-      break;
-    }
-    default:
-      this->write_array(this->buffer_, this->get_buffer_length_());
-  }
-  this->end_data_();
-
-  if (this->model_ == WAVESHARE_EPAPER_2_13_IN_V2 && full_update) {
-    // Write base image again on full refresh
+  if (this->grayscale_) {
+    // low bits to the new data RAM, high bits to the old one, as in the Waveshare 4-gray demo
+    this->command(0x24);
+    this->write_stream_(this->buffer_, this->get_buffer_length_(), STREAM_GRAY_LOW);
     this->command(0x26);
-    this->start_data_();
-    this->write_array(this->buffer_, this->get_buffer_length_());
-    this->end_data_();
+    this->write_stream_(this->buffer_, this->get_buffer_length_(), STREAM_GRAY_HIGH);
+  } else {
+    this->write_ram_(full_update);
   }
 
   // COMMAND DISPLAY UPDATE CONTROL 2
   this->command(0x22);
   switch (this->model_) {
     case WAVESHARE_EPAPER_2_9_IN_V2:
+      // loading the LUT from OTP would replace the grayscale waveform
+      this->data(this->grayscale_ ? 0xC7 : (full_update ? 0xF7 : 0xFF));
+      break;
     case WAVESHARE_EPAPER_1_54_IN_V2:
     case TTGO_EPAPER_2_13_IN_B74:
       this->data(full_update ? 0xF7 : 0xFF);
@@ -702,6 +1581,31 @@ void HOT WaveshareEPaperTypeA::display() {
   if (this->deep_sleep_between_updates_) {
     ESP_LOGI(TAG, "Set the display back to deep sleep");
     this->deep_sleep();
+  } else {
+    this->time_refresh_(full_update);
+  }
+}
+void WaveshareEPaperTypeA::write_ram_(bool full_update) {
+  // COMMAND WRITE RAM
+  this->command(0x24);
+  this->start_data_();
+  switch (this->model_) {
+    case TTGO_EPAPER_2_13_IN_B1: {  // block needed because of variable initializations
+      int16_t wb = ((this->get_width_controller()) >> 3);
+      // rows are sent bottom up
+      for (int i = 0; i < this->get_height_internal(); i++)
+        this->write_array(this->buffer_ + (this->get_height_internal() - 1 - i) * wb, wb);
+      break;
+    }
+    default:
+      this->write_array(this->buffer_, this->get_buffer_length_());
+  }
+  this->end_data_();
+
+  if (this->model_ == WAVESHARE_EPAPER_2_13_IN_V2 && full_update) {
+    // Write base image again on full refresh
+    this->command(0x26);
+    this->write_stream_(this->buffer_, this->get_buffer_length_());
   }
 }
 int WaveshareEPaperTypeA::get_width_internal() {
@@ -755,10 +1659,11 @@ int WaveshareEPaperTypeA::get_height_internal() {
   return 0;
 }
 void WaveshareEPaperTypeA::write_lut_(const uint8_t *lut, const uint8_t size) {
+  if (!this->lut_needs_load_(lut))
+    return;
   // COMMAND WRITE LUT REGISTER
   this->command(0x32);
-  for (uint8_t i = 0; i < size; i++)
-    this->data(lut[i]);
+  this->write_stream_(lut, size);
 }
 WaveshareEPaperTypeA::WaveshareEPaperTypeA(WaveshareEPaperTypeAModel model) : model_(model) {}
 void WaveshareEPaperTypeA::set_full_update_every(uint32_t full_update_every) {
@@ -900,17 +1805,13 @@ void HOT WaveshareEPaper2P7In::display() {
   // COMMAND DATA START TRANSMISSION 1
   this->command(0x10);
   delay(2);
-  for (uint32_t i = 0; i < buf_len; i++) {
-    this->data(this->buffer_[i]);
-  }
+  this->write_stream_(this->buffer_, buf_len);
   delay(2);
 
   // COMMAND DATA START TRANSMISSION 2
   this->command(0x13);
   delay(2);
-  for (uint32_t i = 0; i < buf_len; i++) {
-    this->data(this->buffer_[i]);
-  }
+  this->write_stream_(this->buffer_, buf_len);
 
   // COMMAND DISPLAY REFRESH
   this->command(0x12);
@@ -959,9 +1860,7 @@ void WaveshareEPaper2P7InV2::initialize() {
 }
 void HOT WaveshareEPaper2P7InV2::display() {
   this->command(0x24);
-  this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
-  this->end_data_();
+  this->write_stream_(this->buffer_, this->get_buffer_length_());
 
   // COMMAND DISPLAY REFRESH
   this->command(0x22);
@@ -1034,17 +1933,13 @@ void HOT WaveshareEPaper1P54InBV2::display() {
   // COMMAND DATA START TRANSMISSION 1 (BLACK)
   this->command(0x24);
   delay(2);
-  for (uint32_t i = 0; i < buf_len_half; i++) {
-    this->data(~this->buffer_[i]);
-  }
+  this->write_stream_(this->buffer_, buf_len_half, STREAM_INVERT);
   delay(2);
 
   // COMMAND DATA START TRANSMISSION 2  (RED)
   this->command(0x26);
   delay(2);
-  for (uint32_t i = buf_len_half; i < buf_len_half * 2u; i++) {
-    this->data(this->buffer_[i]);
-  }
+  this->write_stream_(this->buffer_ + buf_len_half, buf_len_half);
   this->command(0x22);
   this->data(0xf7);
   this->command(0x20);
@@ -1191,18 +2086,14 @@ void HOT WaveshareEPaper2P7InB::display() {
   // COMMAND DATA START TRANSMISSION 1 (BLACK)
   this->command(0x10);
   delay(2);
-  for (uint32_t i = 0; i < buf_len_half; i++) {
-    this->data(this->buffer_[i]);
-  }
+  this->write_stream_(this->buffer_, buf_len_half);
   this->command(0x11);
   delay(2);
 
   // COMMAND DATA START TRANSMISSION 2  (RED)
   this->command(0x13);
   delay(2);
-  for (uint32_t i = buf_len_half; i < buf_len_half * 2u; i++) {
-    this->data(this->buffer_[i]);
-  }
+  this->write_stream_(this->buffer_ + buf_len_half, buf_len_half);
   this->command(0x11);
 
   delay(2);
@@ -1274,17 +2165,13 @@ void HOT WaveshareEPaper2P7InBV2::display() {
   // COMMAND DATA START TRANSMISSION 1 (BLACK)
   this->command(0x24);
   delay(2);
-  for (uint32_t i = 0; i < buf_len; i++) {
-    this->data(this->buffer_[i]);
-  }
+  this->write_stream_(this->buffer_, buf_len);
   delay(2);
 
   // COMMAND DATA START TRANSMISSION 2  (RED)
   this->command(0x26);
   delay(2);
-  for (uint32_t i = 0; i < buf_len; i++) {
-    this->data(this->buffer_[i]);
-  }
+  this->write_stream_(this->buffer_, buf_len);
 
   delay(2);
 
@@ -1348,18 +2235,13 @@ void HOT WaveshareEPaper2P9InB::display() {
   // COMMAND DATA START TRANSMISSION 1 (B/W data)
   this->command(0x10);
   delay(2);
-  this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
-  this->end_data_();
+  this->write_stream_(this->buffer_, this->get_buffer_length_());
   delay(2);
 
   // COMMAND DATA START TRANSMISSION 2 (RED data)
   this->command(0x13);
   delay(2);
-  this->start_data_();
-  for (size_t i = 0; i < this->get_buffer_length_(); i++)
-    this->write_byte(0x00);
-  this->end_data_();
+  this->write_stream_(nullptr, this->get_buffer_length_(), STREAM_FILL, 0x00);
   delay(2);
 
   // COMMAND DISPLAY REFRESH
@@ -1435,15 +2317,11 @@ void WaveshareEPaper2P9InD::initialize() {
 void WaveshareEPaper2P9InD::display() {
   // Start transmitting old data (clearing buffer)
   this->command(0x10);  // Command: DTM1 (OLD frame data)
-  this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
-  this->end_data_();
+  this->write_stream_(this->buffer_, this->get_buffer_length_());
 
   // Start transmitting new data (updated content)
   this->command(0x13);  // Command: DTM2 (NEW frame data)
-  this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
-  this->end_data_();
+  this->write_stream_(this->buffer_, this->get_buffer_length_());
 
   // Refresh Display
   this->command(0x12);  // Command: DRF
@@ -1567,9 +2445,7 @@ void HOT WaveshareEPaper2P9InDKE::display() {
   this->data(0);
   // Load image (128/8*296)
   this->command(0x24);
-  this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
-  this->end_data_();
+  this->write_stream_(this->buffer_, this->get_buffer_length_());
   // Image update
   this->command(0x22);
   this->data(0xC7);
@@ -1627,19 +2503,14 @@ void HOT WaveshareEPaper2P9InBV3::display() {
   // COMMAND DATA START TRANSMISSION 1 (B/W data)
   this->command(0x10);
   delay(2);
-  this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
-  this->end_data_();
+  this->write_stream_(this->buffer_, this->get_buffer_length_());
   this->command(0x92);
   delay(2);
 
   // COMMAND DATA START TRANSMISSION 2 (RED data)
   this->command(0x13);
   delay(2);
-  this->start_data_();
-  for (size_t i = 0; i < this->get_buffer_length_(); i++)
-    this->write_byte(0xFF);
-  this->end_data_();
+  this->write_stream_(nullptr, this->get_buffer_length_(), STREAM_FILL, 0xFF);
   this->command(0x92);
   delay(2);
 
@@ -1724,20 +2595,17 @@ void WaveshareEPaper2P9InV2R2::display() {
   if (!this->wait_until_idle_()) {
     this->status_set_warning();
     ESP_LOGE(TAG, "fail idle 1");
+    this->discard_frame_hash_();
     return;
   }
 
   if (this->full_update_every_ == 1) {
     // do single full update
     this->command(0x24);
-    this->start_data_();
-    this->write_array(this->buffer_, this->get_buffer_length_());
-    this->end_data_();
+    this->write_stream_(this->buffer_, this->get_buffer_length_());
 
     // TurnOnDisplay
-    this->command(0x22);
-    this->data(0xF7);
-    this->command(0x20);
+    this->activate_full_refresh_();
     return;
   }
 
@@ -1745,19 +2613,13 @@ void WaveshareEPaper2P9InV2R2::display() {
   if (this->at_update_ == 0) {
     // do base update
     this->command(0x24);
-    this->start_data_();
-    this->write_array(this->buffer_, this->get_buffer_length_());
-    this->end_data_();
+    this->write_stream_(this->buffer_, this->get_buffer_length_());
 
     this->command(0x26);
-    this->start_data_();
-    this->write_array(this->buffer_, this->get_buffer_length_());
-    this->end_data_();
+    this->write_stream_(this->buffer_, this->get_buffer_length_());
 
     // TurnOnDisplay
-    this->command(0x22);
-    this->data(0xF7);
-    this->command(0x20);
+    this->activate_full_refresh_();
   } else {
     // do partial update
     this->reset_();
@@ -1807,9 +2669,7 @@ void WaveshareEPaper2P9InV2R2::display() {
 
     // write b/w
     this->command(0x24);
-    this->start_data_();
-    this->write_array(this->buffer_, this->get_buffer_length_());
-    this->end_data_();
+    this->write_stream_(this->buffer_, this->get_buffer_length_());
 
     // TurnOnDisplayPartial
     this->command(0x22);
@@ -1833,6 +2693,7 @@ void WaveshareEPaper2P9InV2R2::dump_config() {
                 "  Model: 2.9inV2R2\n"
                 "  Full Update Every: %" PRIu32,
                 this->full_update_every_);
+  this->dump_refresh_mode_();
   LOG_PIN("  Reset Pin: ", this->reset_pin_);
   LOG_PIN("  DC Pin: ", this->dc_pin_);
   LOG_PIN("  Busy Pin: ", this->busy_pin_);
@@ -1903,14 +2764,8 @@ void GDEY029T94::initialize() {
 }
 void HOT GDEY029T94::display() {
   this->command(0x24);  // write RAM for black(0)/white (1)
-  this->start_data_();
-  for (uint32_t i = 0; i < this->get_buffer_length_(); i++) {
-    this->write_byte(this->buffer_[i]);
-  }
-  this->end_data_();
-  this->command(0x22);  // Display Update Control
-  this->data(0xF7);
-  this->command(0x20);  // Activate Display Update Sequence
+  this->write_stream_(this->buffer_, this->get_buffer_length_());
+  this->activate_full_refresh_();
   this->wait_until_idle_();
 }
 int GDEY029T94::get_width_internal() { return 128; }
@@ -1918,6 +2773,7 @@ int GDEY029T94::get_height_internal() { return 296; }
 void GDEY029T94::dump_config() {
   LOG_DISPLAY("", "E-Paper (Good Display)", this);
   ESP_LOGCONFIG(TAG, "  Model: 2.9in GDEY029T94");
+  this->dump_refresh_mode_();
   LOG_PIN("  Reset Pin: ", this->reset_pin_);
   LOG_PIN("  DC Pin: ", this->dc_pin_);
   LOG_PIN("  Busy Pin: ", this->busy_pin_);
@@ -2071,16 +2927,8 @@ void GDEW029T5::initialize() {
   if (this->reset_pin_ != nullptr)
     this->deep_sleep_between_updates_ = true;
 
-  // old buffer for partial update
-  RAMAllocator<uint8_t> allocator;
-  this->old_buffer_ = allocator.allocate(this->get_buffer_length_());
-  if (this->old_buffer_ == nullptr) {
-    ESP_LOGE(TAG, "Could not allocate old buffer for display!");
-    return;
-  }
-  for (size_t i = 0; i < this->get_buffer_length_(); i++) {
-    this->old_buffer_[i] = 0xFF;
-  }
+  // old buffer for partial update, without it every update is a full one
+  this->init_old_buffer_(0xFF);
 }
 
 // initialize for full(normal) update
@@ -2124,43 +2972,32 @@ void GDEW029T5::init_partial_() {
 }
 
 void HOT GDEW029T5::display() {
-  bool full_update = this->at_update_ == 0;
+  bool full_update = this->at_update_ == 0 || this->old_buffer_ == nullptr;
+  FrameWindow window = this->get_full_window_();
   if (full_update) {
     this->init_full_();
   } else {
+    if (!this->get_changed_window_(window)) {
+      ESP_LOGD(TAG, "Nothing changed, skipping partial update");
+      return;
+    }
     this->init_partial_();
     this->command(0x91);  // partial in
     // set partial window
-    this->command(0x90);
-    // this->data(0);
-    this->data(0);
-    // this->data(0);
-    this->data((this->get_width_internal() - 1) % 256);
-    this->data(0);
-    this->data(0);
-    this->data(((this->get_height_internal() - 1)) / 256);
-    this->data(((this->get_height_internal() - 1)) % 256);
-    this->data(0x01);
+    this->set_partial_window_(window, false);
   }
   // input old buffer data
   this->command(0x10);
   delay(2);
-  this->start_data_();
-  for (size_t i = 0; i < this->get_buffer_length_(); i++) {
-    this->write_byte(this->old_buffer_[i]);
-  }
-  this->end_data_();
+  this->write_window_(this->old_buffer_ != nullptr ? this->old_buffer_ : this->buffer_, window);
   delay(2);
 
   // COMMAND DATA START TRANSMISSION 2 (B/W only)
   this->command(0x13);
   delay(2);
-  this->start_data_();
-  for (size_t i = 0; i < this->get_buffer_length_(); i++) {
-    this->write_byte(this->buffer_[i]);
-    this->old_buffer_[i] = this->buffer_[i];
-  }
-  this->end_data_();
+  this->write_window_(this->buffer_, window);
+  if (this->old_buffer_ != nullptr)
+    this->store_old_buffer_();
   delay(2);
 
   // COMMAND DISPLAY REFRESH
@@ -2292,13 +3129,9 @@ void GDEW0154M09::clear_() {
   uint32_t pixsize = this->get_buffer_length_();
   for (uint8_t j = 0; j < 2; j++) {
     this->command(CMD_DTM1_DATA_START_TRANS);
-    for (uint32_t count = 0; count < pixsize; count++) {
-      this->data(0x00);
-    }
+    this->write_stream_(nullptr, pixsize, STREAM_FILL, 0x00);
     this->command(CMD_DTM2_DATA_START_TRANS2);
-    for (uint32_t count = 0; count < pixsize; count++) {
-      this->data(0xff);
-    }
+    this->write_stream_(nullptr, pixsize, STREAM_FILL, 0xFF);
     this->command(CMD_DISPLAY_REFRESH);
     delay(10);
     this->wait_until_idle_();
@@ -2309,13 +3142,9 @@ void HOT GDEW0154M09::display() {
   this->init_internal_();
   // "Mode 0 display" for now
   this->command(CMD_DTM1_DATA_START_TRANS);
-  for (uint32_t i = 0; i < this->get_buffer_length_(); i++) {
-    this->data(0xff);
-  }
+  this->write_stream_(nullptr, this->get_buffer_length_(), STREAM_FILL, 0xFF);
   this->command(CMD_DTM2_DATA_START_TRANS2);  // write 'new' data to SRAM
-  for (uint32_t i = 0; i < this->get_buffer_length_(); i++) {
-    this->data(this->buffer_[i]);
-  }
+  this->write_stream_(this->buffer_, this->get_buffer_length_());
   this->command(CMD_DISPLAY_REFRESH);
   delay(10);
   this->wait_until_idle_();
@@ -2368,7 +3197,11 @@ void GDEY042T81::initialize() {
 //   https://github.com/ZinggJM/GxEPD2/blob/03d8e7a533c1493f762e392ead12f1bcb7fab8f9/src/gdey/GxEPD2_420_GDEY042T81.cpp#L351
 //   -> 10ms
 //  10 ms seems to work, so we use this
-GDEY042T81::GDEY042T81() { this->reset_duration_ = 10; }
+GDEY042T81::GDEY042T81() {
+  this->reset_duration_ = 10;
+  // fast updates were the only kind this panel did before the refresh mode existed
+  this->fast_refresh_default_ = true;
+}
 
 void GDEY042T81::reset_() {
   if (this->reset_pin_ != nullptr) {
@@ -2424,24 +3257,35 @@ void GDEY042T81::init_display_() {
   this->wait_until_idle_();
 }
 
+// x positions are in bytes, y positions are line numbers
+void GDEY042T81::set_window_(const FrameWindow &window) {
+  this->command(0x44);  // set Ram-X address start/end position
+  this->data(window.left);
+  this->data(window.right - 1);
+
+  this->command(0x45);  // set Ram-y address start/end position
+  this->data(window.top % 256);
+  this->data(window.top / 256);
+  this->data((window.bottom - 1) % 256);
+  this->data((window.bottom - 1) / 256);
+
+  this->command(0x4E);  // set RAM x address count
+  this->data(window.left);
+  this->command(0x4F);  // set RAM y address count
+  this->data(window.top % 256);
+  this->data(window.top / 256);
+}
+
 // https://github.com/ZinggJM/GxEPD2/blob/03d8e7a533c1493f762e392ead12f1bcb7fab8f9/src/gdey/GxEPD2_420_GDEY042T81.cpp#L366
 void GDEY042T81::update_full_() {
   this->command(0x21);  // display update control
   this->data(0x40);     // bypass RED as 0
   this->data(0x00);     // single chip application
 
-  // only ever do a fast update because slow updates are only relevant
-  // for lower operating temperatures
+  // slow updates are only relevant for lower operating temperatures
   // see
   // https://github.com/ZinggJM/GxEPD2/blob/03d8e7a533c1493f762e392ead12f1bcb7fab8f9/src/gdey/GxEPD2_290_GDEY029T94.h#L30
-  //
-  // Should slow/fast updates be made configurable similar to how GxEPD2 does it? No idea if anyone would need it...
-  this->command(0x1A);  // Write to temperature register
-  this->data(0x6E);
-  this->command(0x22);
-  this->data(0xd7);
-
-  this->command(0x20);
+  this->activate_full_refresh_();
   this->wait_until_idle_();
 }
 
@@ -2465,6 +3309,7 @@ void HOT GDEY042T81::display() {
   if (!this->wait_until_idle_()) {
     this->status_set_warning();
     ESP_LOGE(TAG, "Failed to perform update, display is busy");
+    this->discard_frame_hash_();
     return;
   }
 
@@ -2473,9 +3318,7 @@ void HOT GDEY042T81::display() {
     ESP_LOGD(TAG, "Full update");
     // do single full update
     this->command(0x24);
-    this->start_data_();
-    this->write_array(this->buffer_, this->get_buffer_length_());
-    this->end_data_();
+    this->write_stream_(this->buffer_, this->get_buffer_length_());
 
     // TurnOnDisplay
     this->update_full_();
@@ -2487,37 +3330,43 @@ void HOT GDEY042T81::display() {
     ESP_LOGD(TAG, "Update");
     // do base update
     this->command(0x24);
-    this->start_data_();
-    this->write_array(this->buffer_, this->get_buffer_length_());
-    this->end_data_();
+    this->write_stream_(this->buffer_, this->get_buffer_length_());
 
     this->command(0x26);
-    this->start_data_();
-    this->write_array(this->buffer_, this->get_buffer_length_());
-    this->end_data_();
+    this->write_stream_(this->buffer_, this->get_buffer_length_());
+    this->store_old_buffer_();
 
     // TurnOnDisplay;
     this->update_full_();
   } else {
-    // do partial update (full screen)
+    // do partial update (changed window only)
     // no need to load a LUT for GoodDisplays as they seem to have the LUT onboard
     // GD example code (Display_EPD_W21.cpp@283ff)
     //
     // not setting the BorderWaveform here again (contrary to the GD example) because according to
     // https://github.com/ZinggJM/GxEPD2/blob/03d8e7a533c1493f762e392ead12f1bcb7fab8f9/src/gdey/GxEPD2_420_GDEY042T81.cpp#L358
     // it seems to be enough to set it during display initialization
+    FrameWindow window;
+    if (!this->get_changed_window_(window)) {
+      ESP_LOGD(TAG, "Nothing changed, set the display back to deep sleep");
+      this->deep_sleep();
+      return;
+    }
+
     ESP_LOGD(TAG, "Partial update");
     this->reset_();
     if (!this->wait_until_idle_()) {
       this->status_set_warning();
       ESP_LOGE(TAG, "Failed to perform partial update, display is busy");
+      this->discard_frame_hash_();
       return;
     }
 
+    // only write the changed part of the RAM, the rest still holds the previous frame
+    this->set_window_(window);
     this->command(0x24);
-    this->start_data_();
-    this->write_array(this->buffer_, this->get_buffer_length_());
-    this->end_data_();
+    this->write_window_(this->buffer_, window);
+    this->store_old_buffer_();
 
     // TurnOnDisplay
     this->update_part_();
@@ -2538,6 +3387,7 @@ void GDEY042T81::dump_config() {
                 "  Model: 4.2in B/W GDEY042T81\n"
                 "  Full Update Every: %" PRIu32,
                 this->full_update_every_);
+  this->dump_refresh_mode_();
   LOG_PIN("  Reset Pin: ", this->reset_pin_);
   LOG_PIN("  DC Pin: ", this->dc_pin_);
   LOG_PIN("  Busy Pin: ", this->busy_pin_);
@@ -2602,28 +3452,56 @@ void WaveshareEPaper4P2In::initialize() {
   this->data(0x3C);  // 3A 100HZ   29 150Hz 39 200HZ  31 171HZ
 
   delay(2);
+  this->set_lut_(false);
+}
+void WaveshareEPaper4P2In::set_lut_(bool partial) {
+  // the partial waveforms of the GDEW029T5 share the LUT layout and only drive pixels that change
   // COMMAND LUT FOR VCOM
   this->command(0x20);
-  for (uint8_t i : LUT_VCOM_DC_4_2)
-    this->data(i);
+  if (partial) {
+    this->write_stream_(LUT_20_VCOMDC_PARTIAL_29_5, sizeof(LUT_20_VCOMDC_PARTIAL_29_5));
+  } else {
+    this->write_stream_(LUT_VCOM_DC_4_2, sizeof(LUT_VCOM_DC_4_2));
+  }
   // COMMAND LUT WHITE TO WHITE
   this->command(0x21);
-  for (uint8_t i : LUT_WHITE_TO_WHITE_4_2)
-    this->data(i);
+  if (partial) {
+    this->write_stream_(LUT_21_WW_PARTIAL_29_5, sizeof(LUT_21_WW_PARTIAL_29_5));
+  } else {
+    this->write_stream_(LUT_WHITE_TO_WHITE_4_2, sizeof(LUT_WHITE_TO_WHITE_4_2));
+  }
   // COMMAND LUT BLACK TO WHITE
   this->command(0x22);
-  for (uint8_t i : LUT_BLACK_TO_WHITE_4_2)
-    this->data(i);
+  if (partial) {
+    this->write_stream_(LUT_22_BW_PARTIAL_29_5, sizeof(LUT_22_BW_PARTIAL_29_5));
+  } else {
+    this->write_stream_(LUT_BLACK_TO_WHITE_4_2, sizeof(LUT_BLACK_TO_WHITE_4_2));
+  }
   // COMMAND LUT WHITE TO BLACK
   this->command(0x23);
-  for (uint8_t i : LUT_WHITE_TO_BLACK_4_2)
-    this->data(i);
+  if (partial) {
+    this->write_stream_(LUT_23_WB_PARTIAL_29_5, sizeof(LUT_23_WB_PARTIAL_29_5));
+  } else {
+    this->write_stream_(LUT_WHITE_TO_BLACK_4_2, sizeof(LUT_WHITE_TO_BLACK_4_2));
+  }
   // COMMAND LUT BLACK TO BLACK
   this->command(0x24);
-  for (uint8_t i : LUT_BLACK_TO_BLACK_4_2)
-    this->data(i);
+  if (partial) {
+    this->write_stream_(LUT_24_BB_PARTIAL_29_5, sizeof(LUT_24_BB_PARTIAL_29_5));
+  } else {
+    this->write_stream_(LUT_BLACK_TO_BLACK_4_2, sizeof(LUT_BLACK_TO_BLACK_4_2));
+  }
 }
 void HOT WaveshareEPaper4P2In::display() {
+  const bool partial = this->full_update_every_ > 1 && this->at_update_ != 0 && this->old_buffer_ != nullptr;
+  FrameWindow window = this->get_full_window_();
+  if (partial && !this->get_changed_window_(window)) {
+    ESP_LOGD(TAG, "Nothing changed, skipping partial update");
+    return;
+  }
+  if (this->full_update_every_ > 1)
+    this->set_lut_(partial);
+
   // COMMAND RESOLUTION SETTING
   this->command(0x61);
   this->data(0x01);
@@ -2637,29 +3515,47 @@ void HOT WaveshareEPaper4P2In::display() {
 
   // COMMAND VCOM AND DATA INTERVAL SETTING
   this->command(0x50);
-  this->data(0x97);
+  this->data(partial ? 0x17 : 0x97);  // keep the border floating on partial updates
 
-  // COMMAND DATA START TRANSMISSION 1
+  if (partial) {
+    // COMMAND PARTIAL IN, limited to the changed window
+    this->command(0x91);
+    this->set_partial_window_(window, true);
+  }
+
+  // COMMAND DATA START TRANSMISSION 1, the frame currently shown
   this->command(0x10);
   delay(2);
-  this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
-  this->end_data_();
+  this->write_window_(this->old_buffer_ != nullptr ? this->old_buffer_ : this->buffer_, window);
   delay(2);
   // COMMAND DATA START TRANSMISSION 2
   this->command(0x13);
   delay(2);
-  this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
-  this->end_data_();
+  this->write_window_(this->buffer_, window);
   // COMMAND DISPLAY REFRESH
   this->command(0x12);
+
+  if (this->full_update_every_ > 1) {
+    this->store_old_buffer_();
+    this->at_update_ = (this->at_update_ + 1) % this->full_update_every_;
+  }
+  if (partial) {
+    this->wait_until_idle_();
+    // COMMAND PARTIAL OUT
+    this->command(0x92);
+  }
+}
+void WaveshareEPaper4P2In::set_full_update_every(uint32_t full_update_every) {
+  this->full_update_every_ = full_update_every;
 }
 int WaveshareEPaper4P2In::get_width_internal() { return 400; }
 int WaveshareEPaper4P2In::get_height_internal() { return 300; }
 void WaveshareEPaper4P2In::dump_config() {
   LOG_DISPLAY("", "Waveshare E-Paper", this);
-  ESP_LOGCONFIG(TAG, "  Model: 4.2in");
+  ESP_LOGCONFIG(TAG,
+                "  Model: 4.2in\n"
+                "  Full Update Every: %" PRIu32,
+                this->full_update_every_);
   LOG_PIN("  Reset Pin: ", this->reset_pin_);
   LOG_PIN("  DC Pin: ", this->dc_pin_);
   LOG_PIN("  Busy Pin: ", this->busy_pin_);
@@ -2691,16 +3587,11 @@ void WaveshareEPaper4P2InBV2::initialize() {
 void HOT WaveshareEPaper4P2InBV2::display() {
   // COMMAND DATA START TRANSMISSION 1 (B/W data)
   this->command(0x10);
-  this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
-  this->end_data_();
+  this->write_stream_(this->buffer_, this->get_buffer_length_());
 
   // COMMAND DATA START TRANSMISSION 2 (RED data)
   this->command(0x13);
-  this->start_data_();
-  for (size_t i = 0; i < this->get_buffer_length_(); i++)
-    this->write_byte(0xFF);
-  this->end_data_();
+  this->write_stream_(nullptr, this->get_buffer_length_(), STREAM_FILL, 0xFF);
   delay(2);
 
   // COMMAND DISPLAY REFRESH
@@ -2748,17 +3639,22 @@ void WaveshareEPaper4P2InBV2BWR::initialize() {
 void HOT WaveshareEPaper4P2InBV2BWR::display() {
   const uint32_t buf_len = this->get_buffer_length_() / 2u;
 
-  this->command(0x10);  // Send BW data Transmission
-  delay(2);             // Delay to prevent Watchdog error
-  for (uint32_t i = 0; i < buf_len; ++i) {
-    this->data(this->buffer_[i]);
+  // the controller is only powered off between updates and keeps an unchanged plane in its RAM
+  if (this->plane_changed_(BLACK_PLANE)) {
+    this->command(0x10);  // Send BW data Transmission
+    delay(2);             // Delay to prevent Watchdog error
+    this->write_stream_(this->buffer_, buf_len);
+  } else {
+    ESP_LOGD(TAG, "Black plane unchanged, skipping transmission");
   }
 
-  this->command(0x13);  // Send red data Transmission
-  delay(2);             // Delay to prevent Watchdog error
-  for (uint32_t i = 0; i < buf_len; ++i) {
+  if (this->plane_changed_(RED_PLANE)) {
+    this->command(0x13);  // Send red data Transmission
+    delay(2);             // Delay to prevent Watchdog error
     // Red color need to flip bit from the buffer. Otherwise, red will conqure the screen!
-    this->data(~this->buffer_[buf_len + i]);
+    this->write_stream_(this->buffer_ + buf_len, buf_len, STREAM_INVERT);
+  } else {
+    ESP_LOGD(TAG, "Red plane unchanged, skipping transmission");
   }
 
   // COMMAND DISPLAY REFRESH
@@ -2836,32 +3732,7 @@ void HOT WaveshareEPaper5P8In::display() {
   // COMMAND DATA START TRANSMISSION 1
   this->command(0x10);
 
-  this->start_data_();
-  for (size_t i = 0; i < this->get_buffer_length_(); i++) {
-    uint8_t temp1 = this->buffer_[i];
-    for (uint8_t j = 0; j < 8; j++) {
-      uint8_t temp2;
-      if (temp1 & 0x80) {
-        temp2 = 0x03;
-      } else {
-        temp2 = 0x00;
-      }
-
-      temp2 <<= 4;
-      temp1 <<= 1;
-      j++;
-      if (temp1 & 0x80) {
-        temp2 |= 0x03;
-      } else {
-        temp2 |= 0x00;
-      }
-      temp1 <<= 1;
-      this->write_byte(temp2);
-    }
-
-    App.feed_wdt();
-  }
-  this->end_data_();
+  this->write_stream_(this->buffer_, this->get_buffer_length_(), STREAM_EXPAND);
 
   // COMMAND DISPLAY REFRESH
   this->command(0x12);
@@ -2932,17 +3803,13 @@ void HOT WaveshareEPaper5P8InV2::display() {
   // COMMAND DATA START TRANSMISSION 1
   this->command(0x10);
   delay(2);
-  this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
-  this->end_data_();
+  this->write_stream_(this->buffer_, this->get_buffer_length_());
   delay(2);
 
   // COMMAND DATA START TRANSMISSION 2
   this->command(0x13);
   delay(2);
-  this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
-  this->end_data_();
+  this->write_stream_(this->buffer_, this->get_buffer_length_());
 
   // COMMAND DISPLAY REFRESH
   this->command(0x12);
@@ -2972,14 +3839,8 @@ void WaveshareEPaper5P8InV2::dump_config() {
 // ========================================================
 
 void GDEY0583T81::initialize() {
-  // Allocate buffer for old data for partial updates
-  RAMAllocator<uint8_t> allocator{};
-  this->old_buffer_ = allocator.allocate(this->get_buffer_length_());
-  if (this->old_buffer_ == nullptr) {
-    ESP_LOGE(TAG, "Could not allocate old buffer for display!");
-    return;
-  }
-  memset(this->old_buffer_, 0xFF, this->get_buffer_length_());
+  // Allocate buffer for old data for partial updates, without it every update is a full one
+  this->init_old_buffer_(0xFF);
 
   this->init_full_();
 
@@ -3091,10 +3952,15 @@ void GDEY0583T81::init_display_() {
 }
 
 void HOT GDEY0583T81::display() {
-  bool full_update = this->at_update_ == 0;
+  bool full_update = this->at_update_ == 0 || this->old_buffer_ == nullptr;
+  FrameWindow window = this->get_full_window_();
   if (full_update) {
     this->init_full_();
   } else {
+    if (!this->get_changed_window_(window)) {
+      ESP_LOGD(TAG, "Nothing changed, skipping partial update");
+      return;
+    }
     this->init_partial_();
 
     // VCOM and data interval setting (CDI)
@@ -3106,41 +3972,22 @@ void HOT GDEY0583T81::display() {
     this->command(0x91);
 
     // Partial Window (PTL)
-    //  We use the full screen as the window
-    this->command(0x90);
-
-    // Horizontal start/end channel bank (HRST/HRED)
-    this->data(0);
-    this->data(0);
-    this->data((get_width_internal() - 1) / 256);
-    this->data((get_width_internal() - 1) % 256);
-
-    // Vertical start/end line (VRST/VRED)
-    this->data(0);
-    this->data(0);
-    this->data((get_height_internal() - 1) / 256);
-    this->data((get_height_internal() - 1) % 256);
-
-    this->data(0x01);
+    //  only the part that changed since the last update
+    this->set_partial_window_(window, true);
 
     // Display Start Transmission 1 (DTM1)
     //  in KW mode this writes "OLD" data to SRAM
     this->command(0x10);
-    this->start_data_();
-    this->write_array(this->old_buffer_, this->get_buffer_length_());
-    this->end_data_();
+    this->write_window_(this->old_buffer_, window);
   }
 
   // Display Start Transmission 2 (DTM2)
   //  in KW mode this writes "NEW" data to SRAM
   this->command(0x13);
-  this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
-  this->end_data_();
+  this->write_window_(this->buffer_, window);
 
-  for (size_t i = 0; i < this->get_buffer_length_(); i++) {
-    this->old_buffer_[i] = this->buffer_[i];
-  }
+  if (this->old_buffer_ != nullptr)
+    this->store_old_buffer_();
 
   // Display Refresh (DRF)
   this->command(0x12);
@@ -3222,18 +4069,13 @@ void HOT WaveshareEPaper7P5InBV2::display() {
   // COMMAND DATA START TRANSMISSION 1 (B/W data)
   this->command(0x10);
   delay(2);
-  this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
-  this->end_data_();
+  this->write_stream_(this->buffer_, this->get_buffer_length_());
   delay(2);
 
   // COMMAND DATA START TRANSMISSION 2 (RED data)
   this->command(0x13);
   delay(2);
-  this->start_data_();
-  for (size_t i = 0; i < this->get_buffer_length_(); i++)
-    this->write_byte(0x00);
-  this->end_data_();
+  this->write_stream_(nullptr, this->get_buffer_length_(), STREAM_FILL, 0x00);
   delay(2);
 
   // COMMAND DISPLAY REFRESH
@@ -3379,15 +4221,11 @@ void HOT WaveshareEPaper7P5InBV3::display() {
   uint32_t buf_len = this->get_buffer_length_();
 
   this->command(0x10);
-  for (uint32_t i = 0; i < buf_len; i++) {
-    this->data(0xFF);
-  }
+  this->write_stream_(nullptr, buf_len, STREAM_FILL, 0xFF);
 
   this->command(0x13);  // Start Transmission
   delay(2);
-  for (uint32_t i = 0; i < buf_len; i++) {
-    this->data(~this->buffer_[i]);
-  }
+  this->write_stream_(this->buffer_, buf_len, STREAM_INVERT);
 
   this->command(0x12);  // Display Refresh
   delay(100);           // NOLINT
@@ -3479,15 +4317,11 @@ void HOT WaveshareEPaper7P5InBV3BWR::display() {
 
   this->command(0x10);  // Send BW data Transmission
   delay(2);
-  for (uint32_t i = 0; i < buf_len; i++) {
-    this->data(this->buffer_[i]);
-  }
+  this->write_stream_(this->buffer_, buf_len);
 
   this->command(0x13);  // Send red data Transmission
   delay(2);
-  for (uint32_t i = 0; i < buf_len; i++) {
-    this->data(this->buffer_[i + buf_len]);
-  }
+  this->write_stream_(this->buffer_ + buf_len, buf_len);
 
   this->command(0x12);  // Display Refresh
   delay(100);           // NOLINT
@@ -3550,30 +4384,7 @@ void WaveshareEPaper7P5In::initialize() {
 void HOT WaveshareEPaper7P5In::display() {
   // COMMAND DATA START TRANSMISSION 1
   this->command(0x10);
-  this->start_data_();
-  for (size_t i = 0; i < this->get_buffer_length_(); i++) {
-    uint8_t temp1 = this->buffer_[i];
-    for (uint8_t j = 0; j < 8; j++) {
-      uint8_t temp2;
-      if (temp1 & 0x80) {
-        temp2 = 0x03;
-      } else {
-        temp2 = 0x00;
-      }
-      temp2 <<= 4;
-      temp1 <<= 1;
-      j++;
-      if (temp1 & 0x80) {
-        temp2 |= 0x03;
-      } else {
-        temp2 |= 0x00;
-      }
-      temp1 <<= 1;
-      this->write_byte(temp2);
-    }
-    App.feed_wdt();
-  }
-  this->end_data_();
+  this->write_stream_(this->buffer_, this->get_buffer_length_(), STREAM_EXPAND);
   // COMMAND DISPLAY REFRESH
   this->command(0x12);
 }
@@ -3664,7 +4475,7 @@ static const uint8_t RE3_CMD_PWS[] = {0xE3, 0xAA};
 }  // namespace cmddata_5P65InF
 
 void WaveshareEPaper5P65InF::initialize() {
-  if (this->buffers_[0] == nullptr) {
+  if (!this->buffers_available_()) {
     ESP_LOGE(TAG, "Buffer unavailable!");
     return;
   }
@@ -3733,6 +4544,7 @@ uint32_t WaveshareEPaper5P65InF::idle_timeout_() { return 35000; }
 void WaveshareEPaper5P65InF::dump_config() {
   LOG_DISPLAY("", "Waveshare E-Paper", this);
   ESP_LOGCONFIG(TAG, "  Model: 5.65in-F");
+  ESP_LOGCONFIG(TAG, "  Compressed Buffer: %s", YESNO(this->use_compressed_buffer_));
   LOG_PIN("  Reset Pin: ", this->reset_pin_);
   LOG_PIN("  DC Pin: ", this->dc_pin_);
   LOG_PIN("  Busy Pin: ", this->busy_pin_);
@@ -3757,7 +4569,7 @@ bool WaveshareEPaper5P65InF::wait_until_(WaitForState busy_state) {
 }
 
 void WaveshareEPaper7P3InF::initialize() {
-  if (this->buffers_[0] == nullptr) {
+  if (!this->buffers_available_()) {
     ESP_LOGE(TAG, "Buffer unavailable!");
     return;
   }
@@ -3872,25 +4684,30 @@ void HOT WaveshareEPaper7P3InF::display() {
   // COMMAND POWER ON
   ESP_LOGI(TAG, "Power on the display");
   this->command(0x04);
-  this->wait_until_idle_();
-
+  // the refresh takes up to 35s, continue from the loop instead of blocking it
+  this->wait_until_idle_async_([this]() { this->refresh_(); }, 200);
+}
+void WaveshareEPaper7P3InF::refresh_() {
   // COMMAND REFRESH SCREEN
   ESP_LOGI(TAG, "Refresh the display");
   this->command(0x12);
   this->data(0x00);
-  this->wait_until_idle_();
-
+  this->wait_until_idle_async_([this]() { this->power_off_(); }, 200);
+}
+void WaveshareEPaper7P3InF::power_off_() {
   // COMMAND POWER OFF
   ESP_LOGI(TAG, "Power off the display");
   this->command(0x02);
   this->data(0x00);
-  this->wait_until_idle_();
-
-  if (this->deep_sleep_between_updates_) {
-    ESP_LOGI(TAG, "Set the display to deep sleep");
-    this->command(0x07);
-    this->data(0xA5);
-  }
+  this->wait_until_idle_async_(
+      [this]() {
+        if (this->deep_sleep_between_updates_) {
+          ESP_LOGI(TAG, "Set the display to deep sleep");
+          this->command(0x07);
+          this->data(0xA5);
+        }
+      },
+      200);
 }
 int WaveshareEPaper7P3InF::get_width_internal() { return 800; }
 int WaveshareEPaper7P3InF::get_height_internal() { return 480; }
@@ -3898,6 +4715,7 @@ uint32_t WaveshareEPaper7P3InF::idle_timeout_() { return 35000; }
 void WaveshareEPaper7P3InF::dump_config() {
   LOG_DISPLAY("", "Waveshare E-Paper", this);
   ESP_LOGCONFIG(TAG, "  Model: 7.3in-F");
+  ESP_LOGCONFIG(TAG, "  Compressed Buffer: %s", YESNO(this->use_compressed_buffer_));
   LOG_PIN("  Reset Pin: ", this->reset_pin_);
   LOG_PIN("  DC Pin: ", this->dc_pin_);
   LOG_PIN("  Busy Pin: ", this->busy_pin_);
@@ -3983,6 +4801,13 @@ void WaveshareEPaper7P5InV2::initialize() {
 void HOT WaveshareEPaper7P5InV2::display() {
   uint32_t buf_len = this->get_buffer_length_();
 
+  const bool partial = this->full_update_every_ > 1 && this->at_update_ != 0 && this->old_buffer_ != nullptr;
+  FrameWindow window = this->get_full_window_();
+  if (partial && !this->get_changed_window_(window)) {
+    ESP_LOGD(TAG, "Nothing changed, skipping partial update");
+    return;
+  }
+
   // COMMAND POWER ON
   ESP_LOGI(TAG, "Power on the display and hat");
 
@@ -3993,11 +4818,45 @@ void HOT WaveshareEPaper7P5InV2::display() {
   delay(200);  // NOLINT
   this->wait_until_idle_();
 
-  // COMMAND DATA START TRANSMISSION NEW DATA
-  this->command(0x13);
-  delay(2);
-  for (uint32_t i = 0; i < buf_len; i++) {
-    this->data(~(this->buffer_[i]));
+  if (partial) {
+    // COMMAND VCOM AND DATA INTERVAL SETTING, the waveform depends on old and new data (KW mode)
+    this->command(0x50);
+    this->data(0xA9);
+    this->data(0x07);
+
+    // COMMAND FORCE TEMPERATURE, selects the partial refresh waveform
+    this->command(0xE0);
+    this->data(0x02);
+    this->command(0xE5);
+    this->data(0x6E);
+
+    // COMMAND PARTIAL IN, limited to the changed window
+    this->command(0x91);
+    this->set_partial_window_(window, true);
+
+    // COMMAND DATA START TRANSMISSION OLD DATA
+    this->command(0x10);
+    delay(2);
+    this->write_window_(this->old_buffer_, window);
+
+    // COMMAND DATA START TRANSMISSION NEW DATA
+    this->command(0x13);
+    delay(2);
+    this->write_window_(this->buffer_, window);
+  } else {
+    if (this->full_update_every_ > 1) {
+      // COMMAND VCOM AND DATA INTERVAL SETTING, back to the full refresh waveform
+      this->command(0x50);
+      this->data(0x10);
+      this->data(0x07);
+      this->command(0xE0);
+      this->data(0x00);
+    }
+
+    // COMMAND DATA START TRANSMISSION NEW DATA
+    this->command(0x13);
+    delay(2);
+    this->write_stream_(this->buffer_, buf_len, STREAM_INVERT);
   }
 
   delay(100);  // NOLINT
@@ -4008,18 +4867,33 @@ void HOT WaveshareEPaper7P5InV2::display() {
   delay(100);  // NOLINT
   this->wait_until_idle_();
 
+  if (partial) {
+    // COMMAND PARTIAL OUT
+    this->command(0x92);
+  }
+  if (this->full_update_every_ > 1) {
+    this->store_old_buffer_();
+    this->at_update_ = (this->at_update_ + 1) % this->full_update_every_;
+  }
+
   ESP_LOGV(TAG, "Before command(0x02) (>> power off)");
   this->command(0x02);
   this->wait_until_idle_();
   ESP_LOGV(TAG, "After command(0x02) (>> power off)");
 }
 
+void WaveshareEPaper7P5InV2::set_full_update_every(uint32_t full_update_every) {
+  this->full_update_every_ = full_update_every;
+}
 int WaveshareEPaper7P5InV2::get_width_internal() { return 800; }
 int WaveshareEPaper7P5InV2::get_height_internal() { return 480; }
 uint32_t WaveshareEPaper7P5InV2::idle_timeout_() { return 10000; }
 void WaveshareEPaper7P5InV2::dump_config() {
   LOG_DISPLAY("", "Waveshare E-Paper", this);
-  ESP_LOGCONFIG(TAG, "  Model: 7.5inV2rev2");
+  ESP_LOGCONFIG(TAG,
+                "  Model: 7.5inV2rev2\n"
+                "  Full Update Every: %" PRIu32,
+                this->full_update_every_);
   LOG_PIN("  Reset Pin: ", this->reset_pin_);
   LOG_PIN("  DC Pin: ", this->dc_pin_);
   LOG_PIN("  Busy Pin: ", this->busy_pin_);
@@ -4151,7 +5025,10 @@ void WaveshareEPaper7P5InV2alt::initialize() {
 
 void WaveshareEPaper7P5InV2alt::dump_config() {
   LOG_DISPLAY("", "Waveshare E-Paper", this);
-  ESP_LOGCONFIG(TAG, "  Model: 7.5inV2");
+  ESP_LOGCONFIG(TAG,
+                "  Model: 7.5inV2\n"
+                "  Full Update Every: %" PRIu32,
+                this->full_update_every_);
   LOG_PIN("  Reset Pin: ", this->reset_pin_);
   LOG_PIN("  DC Pin: ", this->dc_pin_);
   LOG_PIN("  Busy Pin: ", this->busy_pin_);
@@ -4253,6 +5130,13 @@ void WaveshareEPaper7P5InV2P::initialize() {
 void HOT WaveshareEPaper7P5InV2P::display() {
   uint32_t buf_len = this->get_buffer_length_();
 
+  // the controller copies new to old data after each refresh (N2OCP), the old buffer only tells what changed
+  FrameWindow window = this->get_full_window_();
+  if (this->full_update_every_ > 1 && this->at_update_ != 0 && !this->get_changed_window_(window)) {
+    ESP_LOGD(TAG, "Nothing changed, skipping partial update");
+    return;
+  }
+
   // COMMAND POWER ON
   ESP_LOGI(TAG, "Power on the display and hat");
 
@@ -4262,9 +5146,7 @@ void HOT WaveshareEPaper7P5InV2P::display() {
 
   if (this->full_update_every_ == 1) {
     this->command(0x13);
-    for (uint32_t i = 0; i < buf_len; i++) {
-      this->data(~(this->buffer_[i]));
-    }
+    this->write_stream_(this->buffer_, buf_len, STREAM_INVERT);
 
     this->turn_on_display_();
 
@@ -4286,18 +5168,14 @@ void HOT WaveshareEPaper7P5InV2P::display() {
 
     this->command(0x10);
     delay(2);
-    for (uint32_t i = 0; i < buf_len; i++) {
-      this->data(~(this->buffer_[i]));
-    }
+    this->write_stream_(this->buffer_, buf_len, STREAM_INVERT);
 
     delay(100);  // NOLINT
     this->wait_until_idle_();
 
     this->command(0x13);
     delay(2);
-    for (uint32_t i = 0; i < buf_len; i++) {
-      this->data(this->buffer_[i]);
-    }
+    this->write_stream_(this->buffer_, buf_len);
 
     delay(100);  // NOLINT
     this->wait_until_idle_();
@@ -4309,33 +5187,20 @@ void HOT WaveshareEPaper7P5InV2P::display() {
     this->command(0xE5);
     this->data(0x6E);
 
-    // Activate partial refresh and set window bounds
+    // Activate partial refresh and limit it to the changed window
     this->command(0x91);
-    this->command(0x90);
-
-    this->data(0x00);
-    this->data(0x00);
-    this->data((get_width_internal() - 1) >> 8 & 0xFF);
-    this->data((get_width_internal() - 1) & 0xFF);
-
-    this->data(0x00);
-    this->data(0x00);
-    this->data((get_height_internal() - 1) >> 8 & 0xFF);
-    this->data((get_height_internal() - 1) & 0xFF);
-
-    this->data(0x01);
+    this->set_partial_window_(window, true);
 
     this->command(0x13);
     delay(2);
-    for (uint32_t i = 0; i < buf_len; i++) {
-      this->data(this->buffer_[i]);
-    }
+    this->write_window_(this->buffer_, window);
 
     delay(100);  // NOLINT
     this->wait_until_idle_();
 
     this->turn_on_display_();
   }
+  this->store_old_buffer_();
 
   ESP_LOGV(TAG, "Before command(0x02) (>> power off)");
   this->command(0x02);
@@ -4418,25 +5283,9 @@ void WaveshareEPaper7P5InBC::initialize() {
 void HOT WaveshareEPaper7P5InBC::display() {
   // COMMAND DATA START TRANSMISSION 1
   this->command(0x10);
-  this->start_data_();
-
-  for (size_t i = 0; i < this->get_buffer_length_(); i++) {
-    // A line of eight source pixels (each a bit in this byte)
-    uint8_t eight_pixels = this->buffer_[i];
-
-    for (uint8_t j = 0; j < 8; j += 2) {
-      /* For bichromatic displays, each byte represents two pixels. Each nibble encodes a pixel: 0=white, 3=black,
-      4=color. Therefore, e.g. 0x44 = two adjacent color pixels, 0x33 is two adjacent black pixels, etc. If you want
-      to draw using the color pixels, change '0x30' with '0x40' and '0x03' with '0x04' below. */
-      uint8_t left_nibble = (eight_pixels & 0x80) ? 0x30 : 0x00;
-      eight_pixels <<= 1;
-      uint8_t right_nibble = (eight_pixels & 0x80) ? 0x03 : 0x00;
-      eight_pixels <<= 1;
-      this->write_byte(left_nibble | right_nibble);
-    }
-    App.feed_wdt();
-  }
-  this->end_data_();
+  /* For bichromatic displays, each byte represents two pixels. Each nibble encodes a pixel: 0=white, 3=black,
+  4=color. Therefore, e.g. 0x44 = two adjacent color pixels, 0x33 is two adjacent black pixels, etc. */
+  this->write_stream_(this->buffer_, this->get_buffer_length_(), STREAM_EXPAND);
 
   // Unlike the 7P5In display, we send the "power on" command here rather than during initialization
   // COMMAND POWER ON
@@ -4530,16 +5379,11 @@ void HOT WaveshareEPaper7P5InHDB::display() {
 
   // BLACK
   this->command(0x24);
-  this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
-  this->end_data_();
+  this->write_stream_(this->buffer_, this->get_buffer_length_());
 
   // RED
   this->command(0x26);
-  this->start_data_();
-  for (size_t i = 0; i < this->get_buffer_length_(); i++)
-    this->write_byte(0x00);
-  this->end_data_();
+  this->write_stream_(nullptr, this->get_buffer_length_(), STREAM_FILL, 0x00);
 
   this->command(0x22);
   this->data(0xC7);
@@ -4629,6 +5473,37 @@ static const uint8_t RE7_CMD[] = {0xe7, 0x1c};
 static const uint8_t RE9_CMD[] = {0xe9, 0x01};
 }  // namespace cmddata_7P5InH
 
+void WaveshareEPaper7P5InH::setup() {
+  this->init_geometry_();
+  const int height = this->get_height_internal();
+  if (this->render_bands_ > 1) {
+    // the buffer only holds the tallest band
+    const int band_height = (height + this->render_bands_ - 1) / this->render_bands_;
+    const uint32_t band_length = this->get_width_internal() / 4u * band_height;
+    this->band_bottom_ = band_height;
+#ifdef USE_ESP32
+    if (this->parallel_transmit_) {
+      this->transmitter_ = new BandTransmitter();  // NOLINT(cppcoreguidelines-owning-memory)
+      if (!this->transmitter_->init(band_length, [this](const uint8_t *data, size_t length) {
+            this->write_stream_(data, length);
+          })) {
+        this->mark_failed();
+        return;
+      }
+    }
+    if (this->transmitter_ == nullptr)
+#endif
+      this->init_internal_(band_length);
+  } else {
+    this->band_bottom_ = height;
+    this->init_internal_(this->get_buffer_length_());
+  }
+  this->setup_pins_();
+  this->spi_setup();
+  this->reset_();
+  this->initialize();
+}
+
 void WaveshareEPaper7P5InH::initialize() {
   ESP_LOGI(TAG, "Initialize");
 
@@ -4674,14 +5549,103 @@ void WaveshareEPaper7P5InH::deep_sleep() {
   this->cmd_data(cmddata_7P5InH::R07_CMD_DSLP, sizeof(cmddata_7P5InH::R07_CMD_DSLP));
 }
 
+void WaveshareEPaper7P5InH::update() {
+  if (this->render_bands_ <= 1) {
+    WaveshareEPaper::update();
+    return;
+  }
+  if (this->refresh_pending_) {
+    ESP_LOGD(TAG, "Previous refresh still in progress, skipping update");
+    return;
+  }
+
+  const int height = this->get_height_internal();
+  const int band_height = (height + this->render_bands_ - 1) / this->render_bands_;
+  const uint32_t line_length = this->get_width_internal() / 4u;
+
+  uint32_t hash = 2166136261UL;
+  const SPIStats since = this->spi_stats_;
+  const uint32_t start = millis();
+  this->power_up_();
+  this->command(cmddata_7P5InH::R10_CMD_DTM1[0]);
+  for (int top = 0; top < height; top += band_height) {
+#ifdef USE_ESP32
+    // render into the buffer the transmit task is not busy with
+    if (this->transmitter_ != nullptr)
+      this->buffer_ = this->transmitter_->acquire();
+#endif
+    this->band_top_ = top;
+    this->band_bottom_ = std::min(top + band_height, height);
+    // limit the drawing work to the band, the writer can still narrow it down further
+    this->start_clipping(this->get_logical_rect_(
+        display::Rect(0, top, this->get_width_internal(), this->band_bottom_ - this->band_top_)));
+    const uint32_t band_length = line_length * (this->band_bottom_ - this->band_top_);
+    this->render_frame_(line_length * top, band_length);
+
+    if (this->skip_unchanged_)
+      hash = hash_buffer_(this->buffer_, band_length, hash);
+#ifdef USE_ESP32
+    if (this->transmitter_ != nullptr) {
+      this->transmitter_->submit(band_length);
+      continue;
+    }
+#endif
+    this->write_stream_(this->buffer_, band_length);
+    App.feed_wdt();
+  }
+  uint32_t wait_time = 0;
+#ifdef USE_ESP32
+  if (this->transmitter_ != nullptr)
+    wait_time = this->transmitter_->flush();
+#endif
+  ESP_LOGD(TAG, "Rendered and sent %u bands in %" PRIu32 " ms, %" PRIu32 " ms waiting for the transmit task",
+           this->render_bands_, millis() - start, wait_time);
+  this->log_spi_stats_(since, start);
+
+  // the frame is only known once all bands were sent, an unchanged one still saves the refresh
+  if (this->skip_unchanged_ && this->frame_unchanged_(hash)) {
+    this->power_down_();
+    return;
+  }
+  this->cmd_data(cmddata_7P5InH::R12_CMD_DRF, sizeof(cmddata_7P5InH::R12_CMD_DRF));
+  this->wait_until_idle_async_([this]() { this->power_down_(); });
+}
+
 void HOT WaveshareEPaper7P5InH::display() {
+  if (this->render_bands_ > 1) {
+    ESP_LOGW(TAG, "The frame is sent while rendering the bands, use update() instead");
+    this->discard_frame_hash_();
+    return;
+  }
+
+  this->power_up_();
   this->command(cmddata_7P5InH::R10_CMD_DTM1[0]);
-  this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
-  this->end_data_();
+  this->write_stream_(this->buffer_, this->get_buffer_length_());
 
   this->cmd_data(cmddata_7P5InH::R12_CMD_DRF, sizeof(cmddata_7P5InH::R12_CMD_DRF));
-  this->wait_until_idle_();
+  this->wait_until_idle_async_([this]() { this->power_down_(); });
+}
+bool WaveshareEPaper7P5InH::set_power_state_(PowerState state) {
+  using namespace cmddata_7P5InH;
+  switch (state) {
+    case POWER_STATE_ON:
+      if (this->power_state_ == POWER_STATE_SLEEP) {
+        // only a reset wakes the controller, which loses its configuration
+        this->initialize();
+      } else {
+        this->cmd_data(R04_CMD_PON, sizeof(R04_CMD_PON));
+        this->wait_until_idle_();
+      }
+      break;
+    case POWER_STATE_OFF:
+      this->cmd_data(R02_CMD_POF, sizeof(R02_CMD_POF));
+      this->wait_until_idle_();
+      break;
+    case POWER_STATE_SLEEP:
+      this->deep_sleep();
+      break;
+  }
+  return true;
 }
 
 uint32_t WaveshareEPaper7P5InH::get_buffer_length_() {
@@ -4690,15 +5654,24 @@ uint32_t WaveshareEPaper7P5InH::get_buffer_length_() {
 }
 
 void WaveshareEPaper7P5InH::fill(Color color) {
+  const int width = this->get_width_internal();
+  const display::Rect rect = this->get_physical_rect_(this->get_clipping());
   const uint8_t bits = this->color_to_2bit_(color);
-  const uint8_t byte_val = bits | (bits << 2) | (bits << 4) | (bits << 6);  // replicate 4 pixels
-  memset(this->buffer_, byte_val, this->get_buffer_length_());
+  if (rect.x > 0 || rect.w < width || rect.y > this->band_top_ || rect.y + rect.h < this->band_bottom_) {
+    // clipped to a part of the buffer
+    const int y_end = std::min<int>(rect.y + rect.h, this->band_bottom_);
+    for (int y = std::max<int>(rect.y, this->band_top_); y < y_end; y++)
+      this->write_span_(rect.x, rect.x + rect.w, y, bits);
+    return;
+  }
+
+  memset(this->buffer_, bits * 0x55, width / 4u * (this->band_bottom_ - this->band_top_));  // replicate 4 pixels
 }
 
-uint8_t WaveshareEPaper7P5InH::color_to_2bit_(const Color &color) {
-  if (color.red > 127) {
-    if (color.green > 170) {
-      if (color.blue > 127) {
+uint8_t WaveshareEPaper7P5InH::rgb_to_2bit_(int red, int green, int blue) {
+  if (red > 127) {
+    if (green > 170) {
+      if (blue > 127) {
         // white
         return 0b01;
       }
@@ -4716,10 +5689,10 @@ uint8_t WaveshareEPaper7P5InH::color_to_2bit_(const Color &color) {
 }
 
 void HOT WaveshareEPaper7P5InH::draw_absolute_pixel_internal(int x, int y, Color color) {
-  if (x >= this->get_width_internal() || y >= this->get_height_internal())
+  if (x >= this->width_internal_ || x < 0 || y >= this->band_bottom_ || y < this->band_top_)
     return;
 
-  const uint32_t pixel_index = x + y * this->get_width_internal();
+  const uint32_t pixel_index = x + (y - this->band_top_) * this->width_internal_;
   const uint32_t byte_index = pixel_index >> 2;
   const uint8_t pos = pixel_index & 0x03;
   const uint8_t shift = (3 - pos) * 2;
@@ -4730,12 +5703,129 @@ void HOT WaveshareEPaper7P5InH::draw_absolute_pixel_internal(int x, int y, Color
   this->buffer_[byte_index] = (uint8_t) ((this->buffer_[byte_index] & ~mask) | (uint8_t) (bits << shift));
 }
 
+void HOT WaveshareEPaper7P5InH::write_span_(int x_start, int x_end, int y, uint8_t bits) {
+  if (x_start >= x_end)
+    return;
+
+  uint8_t *line = this->buffer_ + (y - this->band_top_) * (this->width_internal_ / 4);
+  const uint8_t pattern = bits * 0x55;
+  int first = x_start / 4;
+  const int last = (x_end - 1) / 4;
+  const uint8_t first_mask = 0xFF >> ((x_start & 0x03) * 2);
+  const uint8_t last_mask = 0xFF << ((3 - ((x_end - 1) & 0x03)) * 2);
+  if (first == last) {
+    const uint8_t mask = first_mask & last_mask;
+    line[first] = (line[first] & ~mask) | (pattern & mask);
+    return;
+  }
+
+  line[first] = (line[first] & ~first_mask) | (pattern & first_mask);
+  first++;
+  memset(line + first, pattern, last - first);
+  line[last] = (line[last] & ~last_mask) | (pattern & last_mask);
+}
+
+// 4x4 Bayer matrix, centered and scaled to offsets of -64 to 56 added to each channel
+static const int8_t DITHER_OFFSETS[4][4] = {
+    {-64, 0, -48, 16},
+    {32, -32, 48, -16},
+    {-40, 24, -56, 8},
+    {56, -8, 40, -24},
+};
+
+void HOT WaveshareEPaper7P5InH::draw_pixels_at(int x_start, int y_start, int w, int h, const uint8_t *ptr,
+                                               display::ColorOrder order, display::ColorBitness bitness,
+                                               bool big_endian, int x_offset, int y_offset, int x_pad) {
+  if (this->rotation_ != display::DISPLAY_ROTATION_0_DEGREES ||
+      (bitness != display::COLOR_BITNESS_565 && bitness != display::COLOR_BITNESS_888)) {
+    Display::draw_pixels_at(x_start, y_start, w, h, ptr, order, bitness, big_endian, x_offset, y_offset, x_pad);
+    return;
+  }
+
+  // only the part within the clipping rectangle and the current band is drawn
+  int x_begin = std::max(x_start, 0);
+  int x_end = std::min(x_start + w, this->width_internal_);
+  int y_begin = std::max(y_start, this->band_top_);
+  int y_end = std::min(y_start + h, this->band_bottom_);
+  display::Rect clip = this->get_clipping();
+  if (clip.is_set()) {
+    x_begin = std::max<int>(x_begin, clip.x);
+    x_end = std::min<int>(x_end, clip.x2());
+    y_begin = std::max<int>(y_begin, clip.y);
+    y_end = std::min<int>(y_end, clip.y2());
+  }
+  if (x_begin >= x_end || y_begin >= y_end)
+    return;
+
+  const size_t pixel_size = bitness == display::COLOR_BITNESS_565 ? 2 : 3;
+  const size_t line_stride = (x_offset + w + x_pad) * pixel_size;
+  const int line_length = this->width_internal_ / 4;
+  for (int y = y_begin; y < y_end; y++) {
+    const uint8_t *src = ptr + (y_offset + y - y_start) * line_stride + (x_offset + x_begin - x_start) * pixel_size;
+    uint8_t *dst = this->buffer_ + (y - this->band_top_) * line_length + x_begin / 4;
+    uint8_t packed = 0;
+    uint8_t mask = 0;
+    for (int x = x_begin; x < x_end; x++, src += pixel_size) {
+      // channels in the order they are stored
+      int first, second, third;
+      if (pixel_size == 2) {
+        const uint16_t value = big_endian ? (src[0] << 8) | src[1] : src[0] | (src[1] << 8);
+        first = (value >> 11) << 3 | (value >> 13);
+        second = ((value >> 5) & 0x3F) << 2 | ((value >> 9) & 0x03);
+        third = (value & 0x1F) << 3 | ((value >> 2) & 0x07);
+      } else {
+        first = big_endian ? src[0] : src[2];
+        second = src[1];
+        third = big_endian ? src[2] : src[0];
+      }
+      if (this->dither_) {
+        const int offset = DITHER_OFFSETS[y & 0x03][x & 0x03];
+        first += offset;
+        second += offset;
+        third += offset;
+      }
+
+      uint8_t bits;
+      switch (order) {
+        case display::COLOR_ORDER_BGR:
+          bits = rgb_to_2bit_(third, second, first);
+          break;
+        case display::COLOR_ORDER_GRB:
+          bits = rgb_to_2bit_(second, first, third);
+          break;
+        default:
+          bits = rgb_to_2bit_(first, second, third);
+          break;
+      }
+
+      // whole bytes are stored at once, only partial ones at the ends are merged
+      const uint8_t shift = (3 - (x & 0x03)) * 2;
+      packed |= bits << shift;
+      mask |= 0x03 << shift;
+      if ((x & 0x03) == 3 || x == x_end - 1) {
+        *dst = (*dst & ~mask) | packed;
+        dst++;
+        packed = 0;
+        mask = 0;
+      }
+    }
+  }
+}
+
 int WaveshareEPaper7P5InH::get_width_internal() { return 800; }
 int WaveshareEPaper7P5InH::get_height_internal() { return 480; }
 uint32_t WaveshareEPaper7P5InH::idle_timeout_() { return 10000; }
 void WaveshareEPaper7P5InH::dump_config() {
   LOG_DISPLAY("", "Waveshare E-Paper", this);
-  ESP_LOGCONFIG(TAG, "  Model: 7.5inH");
+  ESP_LOGCONFIG(TAG,
+                "  Model: 7.5inH\n"
+                "  Render Bands: %u\n"
+                "  Dither: %s",
+                this->render_bands_, YESNO(this->dither_));
+#ifdef USE_ESP32
+  ESP_LOGCONFIG(TAG, "  Parallel Transmit: %s", YESNO(this->transmitter_ != nullptr));
+#endif
+  this->dump_power_config_();
   LOG_PIN("  Power Pin: ", this->power_pin_);
   LOG_PIN("  Reset Pin: ", this->reset_pin_);
   LOG_PIN("  DC Pin: ", this->dc_pin_);
@@ -4757,6 +5847,46 @@ static const uint8_t PART_UPDATE_LUT_TTGO_DKE[LUT_SIZE_TTGO_DKE_PART] = {
     // 0x22,   0x17,   0x41,   0x0,    0x32,   0x32
 };
 
+// flag of the DKE sequences, set for partial updates
+static const uint8_t SEQUENCE_DKE_PARTIAL = 0x01;
+
+// clang-format off
+// start and set up data format, 128 x 250
+static const uint8_t SEQUENCE_DKE_SETUP[] PROGMEM = {
+    SEQ_CMD + 0, 0x12,
+    SEQ_WAIT_IDLE,
+    SEQ_CMD + 1, 0x11, 0x03,
+    SEQ_CMD + 2, 0x44, 0x01, 0x10,
+    SEQ_CMD + 4, 0x45, 0x00, 0x00, 0xFA, 0x00,
+    SEQ_CMD + 1, 0x4E, 0x01,
+    SEQ_CMD + 2, 0x4F, 0x00, 0x00,
+    SEQ_END,
+};
+
+// set up partial update, after the LUT was sent
+static const uint8_t SEQUENCE_DKE_PARTIAL_SETUP[] PROGMEM = {
+    SEQ_CMD + 1, 0x3F, 0x22,
+    SEQ_CMD + 1, 0x03, 0x17,
+    SEQ_CMD + 3, 0x04, 0x41, 0x00, 0x32,
+    SEQ_CMD + 1, 0x2C, 0x32,
+    SEQ_CMD + 10, 0x37, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00,
+    SEQ_CMD + 1, 0x3C, 0x80,
+    SEQ_CMD + 1, 0x22, 0xC0,
+    SEQ_CMD + 0, 0x20,
+    SEQ_WAIT_IDLE,
+    SEQ_END,
+};
+
+// commit the data sent, as partial update if flagged
+static const uint8_t SEQUENCE_DKE_COMMIT[] PROGMEM = {
+    SEQ_SKIP_UNLESS, SEQUENCE_DKE_PARTIAL, 3,
+    SEQ_CMD + 1, 0x22, 0xCF,
+    SEQ_CMD + 0, 0x20,
+    SEQ_WAIT_IDLE,
+    SEQ_END,
+};
+// clang-format on
+
 void WaveshareEPaper2P13InDKE::initialize() {}
 void HOT WaveshareEPaper2P13InDKE::display() {
   bool partial = this->at_update_ != 0;
@@ -4768,93 +5898,26 @@ void HOT WaveshareEPaper2P13InDKE::display() {
     ESP_LOGI(TAG, "Performing full e-paper update.");
   }
 
-  // start and set up data format
-  this->command(0x12);
-  this->wait_until_idle_();
-
-  this->command(0x11);
-  this->data(0x03);
-  this->command(0x44);
-  this->data(1);
-  this->data(this->get_width_internal() / 8);
-  this->command(0x45);
-  this->data(0);
-  this->data(0);
-  this->data(this->get_height_internal());
-  this->data(0);
-  this->command(0x4e);
-  this->data(1);
-  this->command(0x4f);
-  this->data(0);
-  this->data(0);
-
-  if (!partial) {
-    // send data
-    this->command(0x24);
-    this->start_data_();
-    this->write_array(this->buffer_, this->get_buffer_length_());
-    this->end_data_();
+  this->run_sequence_(SEQUENCE_DKE_SETUP);
 
-    // commit
-    this->command(0x20);
-    this->wait_until_idle_();
-  } else {
-    // set up partial update
+  if (partial) {
     this->command(0x32);
-    this->start_data_();
-    this->write_array(PART_UPDATE_LUT_TTGO_DKE, sizeof(PART_UPDATE_LUT_TTGO_DKE));
-    this->end_data_();
-    this->command(0x3F);
-    this->data(0x22);
-
-    this->command(0x03);
-    this->data(0x17);
-    this->command(0x04);
-    this->data(0x41);
-    this->data(0x00);
-    this->data(0x32);
-    this->command(0x2C);
-    this->data(0x32);
-
-    this->command(0x37);
-    this->data(0x00);
-    this->data(0x00);
-    this->data(0x00);
-    this->data(0x00);
-    this->data(0x00);
-    this->data(0x40);
-    this->data(0x00);
-    this->data(0x00);
-    this->data(0x00);
-    this->data(0x00);
-
-    this->command(0x3C);
-    this->data(0x80);
-    this->command(0x22);
-    this->data(0xC0);
-    this->command(0x20);
-    this->wait_until_idle_();
-
-    // send data
-    this->command(0x24);
-    this->start_data_();
-    this->write_array(this->buffer_, this->get_buffer_length_());
-    this->end_data_();
-
-    // commit as partial
-    this->command(0x22);
-    this->data(0xCF);
-    this->command(0x20);
-    this->wait_until_idle_();
-
-    // data must be sent again on partial update
-    this->command(0x24);
-    this->start_data_();
-    this->write_array(this->buffer_, this->get_buffer_length_());
-    this->end_data_();
+    this->write_stream_(PART_UPDATE_LUT_TTGO_DKE, sizeof(PART_UPDATE_LUT_TTGO_DKE));
+    this->run_sequence_(SEQUENCE_DKE_PARTIAL_SETUP);
   }
 
-  ESP_LOGI(TAG, "Completed e-paper update.");
+  // send data
+  this->command(0x24);
+  this->write_stream_(this->buffer_, this->get_buffer_length_());
+
+  this->run_sequence_async_(SEQUENCE_DKE_COMMIT, partial ? SEQUENCE_DKE_PARTIAL : 0, [this, partial]() {
+    if (partial) {
+      // data must be sent again on partial update
+      this->command(0x24);
+      this->write_stream_(this->buffer_, this->get_buffer_length_());
+    }
+    ESP_LOGI(TAG, "Completed e-paper update.");
+  });
 }
 
 int WaveshareEPaper2P13InDKE::get_width_internal() { return 128; }
@@ -4881,68 +5944,47 @@ void WaveshareEPaper2P13InDKE::set_full_update_every(uint32_t full_update_every)
 //  - https://github.com/waveshareteam/e-Paper/tree/master/Arduino/epd13in3k
 // ========================================================
 
-// using default wait_until_idle_() function
-void WaveshareEPaper13P3InK::initialize() {
-  this->wait_until_idle_();
-  this->command(0x12);  // SWRESET
-  this->wait_until_idle_();
-
-  this->command(0x0c);  // set soft start
-  this->data(0xae);
-  this->data(0xc7);
-  this->data(0xc3);
-  this->data(0xc0);
-  this->data(0x80);
-
-  this->command(0x01);                            // driver output control
-  this->data((get_height_internal() - 1) % 256);  // Y
-  this->data((get_height_internal() - 1) / 256);  // Y
-  this->data(0x00);
-
-  this->command(0x11);  // data entry mode
-  this->data(0x03);
-
-  // SET WINDOWS
-  // XRAM_START_AND_END_POSITION
-  this->command(0x44);
-  this->data(0 & 0xFF);
-  this->data((0 >> 8) & 0x03);
-  this->data((get_width_internal() - 1) & 0xFF);
-  this->data(((get_width_internal() - 1) >> 8) & 0x03);
-  // YRAM_START_AND_END_POSITION
-  this->command(0x45);
-  this->data(0 & 0xFF);
-  this->data((0 >> 8) & 0x03);
-  this->data((get_height_internal() - 1) & 0xFF);
-  this->data(((get_height_internal() - 1) >> 8) & 0x03);
-
-  this->command(0x3C);  // Border setting
-  this->data(0x01);
+// clang-format off
+// 960 x 680, the RAM is addressed in pixels
+static const uint8_t SEQUENCE_13P3INK_INIT[] PROGMEM = {
+    SEQ_WAIT_IDLE,
+    SEQ_CMD + 0, 0x12,  // SWRESET
+    SEQ_WAIT_IDLE,
+    SEQ_CMD + 5, 0x0C, 0xAE, 0xC7, 0xC3, 0xC0, 0x80,  // set soft start
+    SEQ_CMD + 3, 0x01, 0xA7, 0x02, 0x00,              // driver output control, 680 - 1 gates
+    SEQ_CMD + 1, 0x11, 0x03,                          // data entry mode
+    SEQ_CMD + 4, 0x44, 0x00, 0x00, 0xBF, 0x03,        // XRAM_START_AND_END_POSITION, 0 to 959
+    SEQ_CMD + 4, 0x45, 0x00, 0x00, 0xA7, 0x02,        // YRAM_START_AND_END_POSITION, 0 to 679
+    SEQ_CMD + 1, 0x3C, 0x01,                          // border setting
+    SEQ_CMD + 1, 0x18, 0x80,                          // use the internal temperature sensor
+    SEQ_CMD + 2, 0x4E, 0x00, 0x00,                    // XRAM_ADDRESS
+    SEQ_CMD + 2, 0x4F, 0x00, 0x00,                    // YRAM_ADDRESS
+    SEQ_END,
+};
 
-  this->command(0x18);  // use the internal temperature sensor
-  this->data(0x80);
+// COMMAND DISPLAY REFRESH
+static const uint8_t SEQUENCE_13P3INK_REFRESH[] PROGMEM = {
+    SEQ_CMD + 1, 0x22, 0xF7,
+    SEQ_CMD + 0, 0x20,
+    SEQ_END,
+};
+// clang-format on
 
-  // SET CURSOR
-  // XRAM_ADDRESS
-  this->command(0x4E);
-  this->data(0 & 0xFF);
-  this->data((0 >> 8) & 0x03);
-  // YRAM_ADDRESS
-  this->command(0x4F);
-  this->data(0 & 0xFF);
-  this->data((0 >> 8) & 0x03);
-}
+// using default wait_until_idle_() function
+void WaveshareEPaper13P3InK::initialize() { this->run_sequence_(SEQUENCE_13P3INK_INIT); }
 void HOT WaveshareEPaper13P3InK::display() {
   // do single full update
   this->command(0x24);
   this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
+  if (this->compressed_buffer_ != nullptr) {
+    this->compressed_buffer_->stream([this](const uint8_t *data, size_t length) { this->write_array(data, length); });
+    ESP_LOGD(TAG, "Compressed buffer size: %" PRIu32 " bytes", this->compressed_buffer_->get_compressed_size());
+  } else {
+    this->write_array(this->buffer_, this->get_buffer_length_());
+  }
   this->end_data_();
 
-  // COMMAND DISPLAY REFRESH
-  this->command(0x22);
-  this->data(0xF7);
-  this->command(0x20);
+  this->run_sequence_(SEQUENCE_13P3INK_REFRESH);
 }
 
 int WaveshareEPaper13P3InK::get_width_internal() { return 960; }
@@ -4951,6 +5993,7 @@ uint32_t WaveshareEPaper13P3InK::idle_timeout_() { return 10000; }
 void WaveshareEPaper13P3InK::dump_config() {
   LOG_DISPLAY("", "Waveshare E-Paper", this);
   ESP_LOGCONFIG(TAG, "  Model: 13.3inK");
+  ESP_LOGCONFIG(TAG, "  Compressed Buffer: %s", YESNO(this->use_compressed_buffer_));
   LOG_PIN("  Reset Pin: ", this->reset_pin_);
   LOG_PIN("  DC Pin: ", this->dc_pin_);
   LOG_PIN("  Busy Pin: ", this->busy_pin_);
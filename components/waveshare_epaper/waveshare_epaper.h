@@ -3,13 +3,60 @@
 #include "esphome/core/component.h"
 #include "esphome/components/spi/spi.h"
 #include "esphome/components/display/display_buffer.h"
+#include "band_transmitter.h"
+#include "compressed_buffer.h"
+
+#ifdef USE_SENSOR
+#include "esphome/components/sensor/sensor.h"
+#endif
 
 namespace esphome {
 namespace waveshare_epaper {
 
-class WaveshareEPaperBase : public display::DisplayBuffer,
-                            public spi::SPIDevice<spi::BIT_ORDER_MSB_FIRST, spi::CLOCK_POLARITY_LOW,
-                                                  spi::CLOCK_PHASE_LEADING, spi::DATA_RATE_2MHZ> {
+// Supply state of the controller between refreshes
+enum PowerState : uint8_t {
+  POWER_STATE_ON = 0,  // booster running, ready to refresh
+  POWER_STATE_OFF,     // booster off, registers and RAM are kept
+  POWER_STATE_SLEEP,   // deep sleep, needs a reset and initialization
+};
+
+// State to enter once a refresh finished
+enum PowerMode : uint8_t {
+  POWER_MODE_AUTO = 0,  // the cheapest state for the measured update interval and wake up costs
+  POWER_MODE_ALWAYS_ON,
+  POWER_MODE_POWER_OFF,
+  POWER_MODE_DEEP_SLEEP,
+};
+
+using WaveshareEPaperSPI = spi::SPIDevice<spi::BIT_ORDER_MSB_FIRST, spi::CLOCK_POLARITY_LOW,
+                                         spi::CLOCK_PHASE_LEADING, spi::DATA_RATE_2MHZ>;
+
+// Bus traffic of a driver, to compare the throughput of changes without a logic analyzer
+struct SPIStats {
+  uint32_t commands{0};
+  // CS assertions
+  uint32_t transactions{0};
+  uint32_t bytes{0};
+  // time spent waiting for the busy pin, in ms
+  uint32_t busy_time{0};
+};
+
+// Opcodes of the command sequences run by WaveshareEPaperBase::run_sequence_(). A sequence is a byte table (kept in
+// flash), every entry starts with its opcode:
+//   SEQ_CMD + n, command, n data bytes    send a command with up to SEQ_MAX_DATA data bytes
+//   SEQ_DELAY, ms                         wait up to 255 ms
+//   SEQ_WAIT_IDLE                         wait until the busy pin signals idle
+//   SEQ_SKIP_IF / SEQ_SKIP_UNLESS, mask, n   skip the next n bytes if any / none of the mask bits are in the flags
+//   SEQ_END
+static const uint8_t SEQ_CMD = 0x00;
+static const uint8_t SEQ_MAX_DATA = 0x7F;
+static const uint8_t SEQ_DELAY = 0x80;
+static const uint8_t SEQ_WAIT_IDLE = 0x81;
+static const uint8_t SEQ_SKIP_IF = 0x82;
+static const uint8_t SEQ_SKIP_UNLESS = 0x83;
+static const uint8_t SEQ_END = 0xFF;
+
+class WaveshareEPaperBase : public display::DisplayBuffer, public WaveshareEPaperSPI {
  public:
   void set_dc_pin(GPIOPin *dc_pin) { dc_pin_ = dc_pin; }
   float get_setup_priority() const override;
@@ -17,10 +64,30 @@ class WaveshareEPaperBase : public display::DisplayBuffer,
   void set_reset_pin(GPIOPin *reset) { this->reset_pin_ = reset; }
   void set_busy_pin(GPIOPin *busy) { this->busy_pin_ = busy; }
   void set_reset_duration(uint32_t reset_duration) { this->reset_duration_ = reset_duration; }
+  void set_compressed_buffer(bool compressed_buffer) { this->use_compressed_buffer_ = compressed_buffer; }
+  void set_skip_unchanged(bool skip_unchanged) { this->skip_unchanged_ = skip_unchanged; }
+  // Number of updates skipped because the frame did not change
+  uint32_t get_skipped_updates() const { return this->skipped_updates_; }
+  // Content drawn once and kept in a copy of the buffer, every frame starts from that copy instead of a cleared
+  // buffer and only the writer's dynamic content is drawn on top.
+  void set_static_layer(display::display_writer_t &&static_layer) { this->static_layer_ = std::move(static_layer); }
+  // Draw the static layer again with the next update.
+  void invalidate_static_layer() { this->static_layer_valid_ = false; }
+  void set_power_mode(PowerMode power_mode) { this->power_mode_ = power_mode; }
+  // Supply current of the controller in each power state in mA, used for the automatic mode and the estimates.
+  void set_state_current(PowerState state, float current) { this->state_current_[state] = current; }
+#ifdef USE_SENSOR
+  void set_average_current_sensor(sensor::Sensor *average_current_sensor) {
+    this->average_current_sensor_ = average_current_sensor;
+  }
+  void set_charge_sensor(sensor::Sensor *charge_sensor) { this->charge_sensor_ = charge_sensor; }
+#endif
 
   void command(uint8_t value);
   void data(uint8_t value);
   void cmd_data(const uint8_t *data, size_t length);
+  // Totals since boot
+  const SPIStats &get_spi_stats() const { return this->spi_stats_; }
 
   virtual void display() = 0;
   virtual void initialize() = 0;
@@ -34,6 +101,22 @@ class WaveshareEPaperBase : public display::DisplayBuffer,
 
  protected:
   bool wait_until_idle_();
+  // Non-blocking counterpart of wait_until_idle_(): the busy pin is polled from the scheduler and on_idle is called
+  // once the controller is idle (or timed out), optionally after an additional settle time.
+  // Updates are skipped until then.
+  void wait_until_idle_async_(std::function<void()> &&on_idle = nullptr, uint32_t settle_time = 0);
+  void poll_busy_();
+
+  // Run a command sequence (see SEQ_CMD) to its end, flags select the conditional parts. Consecutive commands are
+  // sent within a single CS assertion. Busy waits use the base class wait_until_idle_().
+  void run_sequence_(const uint8_t *sequence, uint8_t flags = 0);
+  // Same without blocking: delays and busy waits continue from the scheduler, on_done is called at the end.
+  // Updates are skipped until then.
+  void run_sequence_async_(const uint8_t *sequence, uint8_t flags, std::function<void()> &&on_done = nullptr);
+  // Run the sequence up to its end or, unless blocking, up to the next wait. Returns the wait entry, nullptr at the
+  // end.
+  const uint8_t *run_sequence_part_(const uint8_t *sequence, uint8_t flags, bool blocking);
+  virtual bool is_idle_() { return this->busy_pin_ == nullptr || !this->busy_pin_->digital_read(); }
 
   void setup_pins_();
 
@@ -48,30 +131,221 @@ class WaveshareEPaperBase : public display::DisplayBuffer,
 
   virtual int get_width_controller() { return this->get_width_internal(); };
 
+  // Cache the panel geometry, so the per-pixel code does not need virtual calls. Called first thing in setup().
+  void init_geometry_();
+  int width_internal_{0};
+  int height_internal_{0};
+  int width_controller_{0};
+  uint32_t buffer_length_{0};
+
+  // Convert a rectangle in rotated display coordinates to panel coordinates, clamped to the panel.
+  display::Rect get_physical_rect_(display::Rect rect);
+  // Convert a rectangle in panel coordinates to rotated display coordinates.
+  display::Rect get_logical_rect_(display::Rect rect);
+  // Word-wise FNV-1a variant used to detect changes between frames, a change to a single word always alters it.
+  // Pass the previous result as hash to continue it over several parts.
+  static uint32_t hash_buffer_(const uint8_t *data, uint32_t length, uint32_t hash = 2166136261UL);
+  // Fingerprint of the frame in the buffer or the compressed buffer.
+  virtual uint32_t get_frame_hash_();
+  // Check whether the frame with the given fingerprint is the one displayed last and remember it otherwise.
+  bool frame_unchanged_(uint32_t hash);
+  // Called by display() paths that return without sending the frame, so the next update is not skipped as unchanged.
+  void discard_frame_hash_() { this->frame_hash_valid_ = false; }
+
   virtual uint32_t get_buffer_length_() = 0;  // NOLINT(readability-identifier-naming)
   uint32_t reset_duration_{200};
 
+  // Run the writer on top of the static layer, the part of the buffer starting at offset bytes into the frame is
+  // saved to or restored from it. The layer is drawn first as long as it is not valid.
+  void render_frame_(uint32_t offset, uint32_t length);
+  // Copy length bytes of the buffer to (save) or from the static layer, starting at offset bytes into the frame.
+  virtual void copy_static_layer_(bool save, uint32_t offset, uint32_t length);
+  display::display_writer_t static_layer_{nullptr};
+  uint8_t *static_buffer_{nullptr};
+  bool static_layer_valid_{false};
+
+  // Switch the controller to a power state, called only with a state differing from power_state_. Models with power
+  // management override it, the others stay on.
+  virtual bool set_power_state_(PowerState state) { return false; }
+  // Bring the controller back on before sending a frame, measuring what the wake up took.
+  void power_up_();
+  // Enter the state chosen by the power mode once a refresh finished.
+  void power_down_();
+  PowerState choose_power_state_();
+  // Book the time spent in the current state and publish the estimates.
+  void account_power_state_();
+  void dump_power_config_();
+
+  PowerMode power_mode_{POWER_MODE_AUTO};
+  PowerState power_state_{POWER_STATE_ON};
+  uint32_t power_state_start_{0};
+  // smoothed time between frames sent to the controller, in ms
+  uint32_t update_interval_{0};
+  uint32_t last_power_up_{0};
+  // measured time to get back on from each state, in ms
+  uint32_t wake_time_[3]{};
+  // rough defaults for UC81xx/SSD16xx controllers, in mA
+  float state_current_[3]{1.5f, 0.02f, 0.001f};
+  // charge drawn since boot in mAs, and the time it was accumulated over
+  float charge_{0.0f};
+  uint32_t charge_time_{0};
+#ifdef USE_SENSOR
+  sensor::Sensor *average_current_sensor_{nullptr};
+  sensor::Sensor *charge_sensor_{nullptr};
+#endif
+
+  // Use a run-length encoded frame buffer instead of buffer_, unit_size bytes form one run-length unit
+  bool init_compressed_buffer_(uint8_t unit_size);
+
+  // Previous frame as transmitted to the controller, for controllers taking old and new data and to find the
+  // changed part of a frame.
+  bool init_old_buffer_(uint8_t value);
+  // Remember the buffer as transmitted. With auto clear the next frame is drawn from scratch anyway, so the two
+  // buffers are swapped instead of copied.
+  void store_old_buffer_();
+  uint8_t *old_buffer_{nullptr};
+  CompressedBuffer *compressed_buffer_{nullptr};
+  bool use_compressed_buffer_{false};
+
+  // Counting versions of the SPIDevice writes, the drivers reach the bus only through these.
+  void write_byte(uint8_t data) {
+    this->spi_stats_.bytes++;
+    WaveshareEPaperSPI::write_byte(data);
+  }
+  void write_array(const uint8_t *data, size_t length) {
+    this->spi_stats_.bytes += length;
+    WaveshareEPaperSPI::write_array(data, length);
+  }
+  // Log the traffic since the given snapshot, for the frame that was just sent.
+  void log_spi_stats_(const SPIStats &since, uint32_t start);
+  SPIStats spi_stats_;
+
   void start_command_();
   void end_command_();
   void start_data_();
   void end_data_();
 
+  enum StreamTransform : uint8_t {
+    STREAM_IDENTITY,  // send the source as is
+    STREAM_INVERT,    // send the inverted source
+    STREAM_FILL,      // send length times fill_value, the source is not read
+    STREAM_EXPAND,    // send every source bit as a 4-bit pixel, set bits become 0x3 (length counts source bytes)
+    // send the inverted high or low bit plane of 2-bit pixels, so black sets both bits like the grayscale waveform
+    // expects (length counts source bytes and is a multiple of 4)
+    STREAM_GRAY_HIGH,
+    STREAM_GRAY_LOW,
+  };
+  // Send length bytes of display data within a single CS assertion. Transformed data goes through a small bounce
+  // buffer, so the bus still transfers whole chunks instead of single bytes. A plane of a multi-plane buffer is
+  // selected by passing its start as source.
+  void write_stream_(const uint8_t *source, uint32_t length, StreamTransform transform = STREAM_IDENTITY,
+                     uint8_t fill_value = 0x00);
+
   GPIOPin *power_pin_{nullptr};
   GPIOPin *reset_pin_{nullptr};
   GPIOPin *dc_pin_;
   GPIOPin *busy_pin_{nullptr};
   virtual uint32_t idle_timeout_() { return 1000u; }  // NOLINT(readability-identifier-naming)
+
+  bool skip_unchanged_{false};
+  bool frame_hash_valid_{false};
+  uint32_t frame_hash_{0};
+  uint32_t skipped_updates_{0};
+
+  std::function<void()> on_idle_{nullptr};
+  uint32_t busy_wait_start_{0};
+  uint32_t busy_wait_settle_time_{0};
+  bool refresh_pending_{false};
+};
+
+// Waveform of a full refresh on SSD1680/SSD1683 based panels
+enum RefreshMode : uint8_t {
+  REFRESH_MODE_AUTO = 0,  // fast if the temperature allows it, otherwise the model default
+  REFRESH_MODE_FAST,      // fast waveform loaded for a forced temperature
+  REFRESH_MODE_NORMAL,    // waveform for the temperature measured by the controller
 };
 
 class WaveshareEPaper : public WaveshareEPaperBase {
  public:
   void fill(Color color) override;
 
-  display::DisplayType get_display_type() override { return display::DisplayType::DISPLAY_TYPE_BINARY; }
+  display::DisplayType get_display_type() override {
+    return this->grayscale_ ? display::DisplayType::DISPLAY_TYPE_GRAYSCALE : display::DisplayType::DISPLAY_TYPE_BINARY;
+  }
+
+  // Store 2 bits per pixel and refresh with a 4-level grayscale waveform, only for models sending it.
+  void set_grayscale(bool grayscale) { this->grayscale_ = grayscale; }
+  void set_refresh_mode(RefreshMode refresh_mode) { this->refresh_mode_ = refresh_mode; }
+  void set_fast_refresh_min_temperature(float temperature) { this->fast_refresh_min_temperature_ = temperature; }
+#ifdef USE_SENSOR
+  void set_temperature_sensor(sensor::Sensor *temperature_sensor) { this->temperature_sensor_ = temperature_sensor; }
+#endif
+  // Waveform tables replacing the built-in ones, the length is checked by the config validation.
+  void set_full_lut(const std::vector<uint8_t> &lut) { this->full_lut_ = lut; }
+  void set_partial_lut(const std::vector<uint8_t> &lut) { this->partial_lut_ = lut; }
+
+  // Writes binary images straight into the buffer in any rotation, a rotated row is walked down a panel column
+  // instead of converting every pixel position. Grayscale and compressed buffers take the per-pixel path.
+  void draw_pixels_at(int x_start, int y_start, int w, int h, const uint8_t *ptr, display::ColorOrder order,
+                      display::ColorBitness bitness, bool big_endian, int x_offset, int y_offset, int x_pad) override;
 
  protected:
+  // Part of the frame given as rows [top, bottom) and byte columns [left, right)
+  struct FrameWindow {
+    int top;
+    int bottom;
+    int left;
+    int right;
+  };
+
   void draw_absolute_pixel_internal(int x, int y, Color color) override;
   uint32_t get_buffer_length_() override;
+  uint8_t get_gray_level_(Color color);
+  // Set the pixels [x_start, x_end) of panel line y to the bits of pattern, which repeats the pixel value.
+  void write_span_(int x_start, int x_end, int y, uint8_t pattern);
+
+  FrameWindow get_full_window_();
+  // Compute the window covering everything that changed since the last transmitted frame.
+  // Returns false if nothing changed, the full window is reported as long as there is no old frame yet.
+  bool get_changed_window_(FrameWindow &window);
+  // Send the part of source within the window, row by row.
+  void write_window_(const uint8_t *source, const FrameWindow &window, StreamTransform transform = STREAM_IDENTITY);
+  // Set the partial window (PTL, 0x90) of UC81xx controllers, wide ones take two bytes per horizontal position.
+  void set_partial_window_(const FrameWindow &window, bool wide);
+
+  // Start a full refresh of SSD1680/SSD1683 controllers with the waveform picked by the refresh mode.
+  void activate_full_refresh_();
+  bool use_fast_refresh_();
+  void dump_refresh_mode_();
+
+  // Waveform table for a full or partial refresh, a configured table takes precedence over the built-in one.
+  const uint8_t *get_lut_(bool full, const uint8_t *builtin) const;
+  // Remember lut as loaded into the LUT registers. Returns false if it already was, so the upload can be skipped.
+  // The controller forgets its LUT on a reset and in deep sleep, call invalidate_lut_() there.
+  bool lut_needs_load_(const uint8_t *lut);
+  void invalidate_lut_() { this->loaded_lut_ = nullptr; }
+  // Log how long the refresh that was just activated takes, waiting for it in the background.
+  void time_refresh_(bool full);
+
+  uint32_t partial_bytes_saved_{0};
+
+  static const uint8_t SSD1680_LUT_SIZE = 153;
+  // 4-level waveform for SSD1680 panels, from the Waveshare 2.9in V2 demo code
+  static const uint8_t SSD1680_GRAYSCALE_LUT[SSD1680_LUT_SIZE];
+
+  // the buffer holds 2-bit gray levels, 0 is black and 3 is white
+  bool grayscale_{false};
+  std::vector<uint8_t> full_lut_;
+  std::vector<uint8_t> partial_lut_;
+  const uint8_t *loaded_lut_{nullptr};
+
+  RefreshMode refresh_mode_{REFRESH_MODE_AUTO};
+  // used by the auto mode without a temperature reading
+  bool fast_refresh_default_{false};
+  float fast_refresh_min_temperature_{10.0f};
+#ifdef USE_SENSOR
+  sensor::Sensor *temperature_sensor_{nullptr};
+#endif
 };
 
 class WaveshareEPaperBWR : public WaveshareEPaperBase {
@@ -81,8 +355,19 @@ class WaveshareEPaperBWR : public WaveshareEPaperBase {
   display::DisplayType get_display_type() override { return display::DisplayType::DISPLAY_TYPE_COLOR; }
 
  protected:
+  enum Plane { BLACK_PLANE = 0, RED_PLANE = 1 };
+
   void draw_absolute_pixel_internal(int x, int y, Color color) override;
   uint32_t get_buffer_length_() override;
+
+  // Write a run of pixels [x_start, x_end) on line y to both planes at once.
+  void write_span_(int x_start, int x_end, int y, Color color);
+  // Check whether a plane differs from the one transmitted last time and remember it as transmitted.
+  // Only useful for controllers that keep their RAM between updates.
+  bool plane_changed_(Plane plane);
+
+  uint32_t plane_hash_[2]{};
+  bool plane_hash_valid_[2]{};
 };
 
 class WaveshareEPaper7C : public WaveshareEPaperBase {
@@ -97,12 +382,17 @@ class WaveshareEPaper7C : public WaveshareEPaperBase {
   uint32_t get_buffer_length_() override;
   void setup() override;
 
+  uint32_t get_frame_hash_() override;
+  void copy_static_layer_(bool save, uint32_t offset, uint32_t length) override;
+
   void init_internal_7c_(uint32_t buffer_length);
+  bool buffers_available_() { return this->buffers_[0] != nullptr || this->compressed_buffer_ != nullptr; }
   void send_buffers_();
+  void send_packed_(const uint8_t *data, uint32_t length);
   void reset_();
 
   static const int NUM_BUFFERS = 10;
-  uint8_t *buffers_[NUM_BUFFERS];
+  uint8_t *buffers_[NUM_BUFFERS]{};
 };
 
 enum WaveshareEPaperTypeAModel {
@@ -156,6 +446,8 @@ class WaveshareEPaperTypeA : public WaveshareEPaper {
 
  protected:
   void write_lut_(const uint8_t *lut, uint8_t size);
+  // Send the 1-bit frame to the RAM, full updates of the 2.13in V2 also refresh the base image.
+  void write_ram_(bool full_update);
 
   void init_display_();
 
@@ -294,7 +586,6 @@ class GDEW029T5 : public WaveshareEPaper {
   bool deep_sleep_between_updates_{false};
   bool power_is_on_{false};
   bool is_deep_sleep_{false};
-  uint8_t *old_buffer_{nullptr};
 };
 
 class GDEY029T94 : public WaveshareEPaper {
@@ -518,6 +809,7 @@ class GDEY042T81 : public WaveshareEPaper {
 
  private:
   void reset_();
+  void set_window_(const FrameWindow &window);
   void update_full_();
   void update_part_();
   void init_display_();
@@ -560,10 +852,17 @@ class WaveshareEPaper4P2In : public WaveshareEPaper {
     this->data(0xA5);  // check byte
   }
 
+  void set_full_update_every(uint32_t full_update_every);
+
  protected:
   int get_width_internal() override;
 
   int get_height_internal() override;
+
+  void set_lut_(bool partial);
+
+  uint32_t full_update_every_{1};
+  uint32_t at_update_{0};
 };
 
 class WaveshareEPaper4P2InBV2 : public WaveshareEPaper {
@@ -719,7 +1018,6 @@ class GDEY0583T81 : public WaveshareEPaper {
   uint32_t at_update_{0};
   bool power_is_on_{false};
   bool is_deep_sleep_{false};
-  uint8_t *old_buffer_{nullptr};
 };
 
 class WaveshareEPaper5P65InF : public WaveshareEPaper7C {
@@ -763,6 +1061,8 @@ class WaveshareEPaper7P3InF : public WaveshareEPaper7C {
   void deep_sleep() override { ; }
 
   bool wait_until_idle_();
+  void refresh_();
+  void power_off_();
 
   bool deep_sleep_between_updates_{true};
 };
@@ -931,12 +1231,17 @@ class WaveshareEPaper7P5InV2 : public WaveshareEPaper {
     this->data(0xA5);  // check byte
   }
 
+  void set_full_update_every(uint32_t full_update_every);
+
  protected:
   int get_width_internal() override;
 
   int get_height_internal() override;
 
   uint32_t idle_timeout_() override;
+
+  uint32_t full_update_every_{1};
+  uint32_t at_update_{0};
 };
 
 class WaveshareEPaper7P5InV2alt : public WaveshareEPaper7P5InV2 {
@@ -1017,8 +1322,12 @@ class WaveshareEPaper7P5InHDB : public WaveshareEPaper {
 
 class WaveshareEPaper7P5InH : public WaveshareEPaper {
  public:
+  void setup() override;
+
   void initialize() override;
 
+  void update() override;
+
   void display() override;
 
   void dump_config() override;
@@ -1029,6 +1338,20 @@ class WaveshareEPaper7P5InH : public WaveshareEPaper {
 
   void deep_sleep() override;
 
+  // Render the frame in this many horizontal bands, running the writer once per band.
+  // Only a single band is kept in memory, at the cost of rendering time.
+  void set_render_bands(uint8_t render_bands) { this->render_bands_ = render_bands; }
+#ifdef USE_ESP32
+  // Send each band from a separate task while the next one is rendered, needs two band buffers.
+  void set_parallel_transmit(bool parallel_transmit) { this->parallel_transmit_ = parallel_transmit; }
+#endif
+  // Ordered dithering of images drawn with RGB565/888 data, for photos and gradients
+  void set_dither(bool dither) { this->dither_ = dither; }
+
+  // Converts unrotated RGB565/888 rows straight into the packed buffer, other formats take the per-pixel path.
+  void draw_pixels_at(int x_start, int y_start, int w, int h, const uint8_t *ptr, display::ColorOrder order,
+                      display::ColorBitness bitness, bool big_endian, int x_offset, int y_offset, int x_pad) override;
+
  protected:
   void draw_absolute_pixel_internal(int x, int y, Color color) override;
 
@@ -1041,6 +1364,9 @@ class WaveshareEPaper7P5InH : public WaveshareEPaper {
   uint32_t idle_timeout_() override;
 
   bool wait_until_idle_();
+  // busy pin is low while the controller is busy
+  bool is_idle_() override { return this->busy_pin_ == nullptr || this->busy_pin_->digital_read(); }
+  bool set_power_state_(PowerState state) override;
 
   void reset_() {
     if (this->reset_pin_ == nullptr) {
@@ -1055,7 +1381,29 @@ class WaveshareEPaper7P5InH : public WaveshareEPaper {
     delay(200);  // NOLINT
   };
 
-  uint8_t color_to_2bit_(const Color &color);
+  static uint8_t rgb_to_2bit_(int red, int green, int blue);
+  // Panel colour of color, the last conversion is cached since drawing mostly repeats a colour
+  uint8_t color_to_2bit_(const Color &color) {
+    if (color != this->last_color_) {
+      this->last_color_ = color;
+      this->last_bits_ = rgb_to_2bit_(color.red, color.green, color.blue);
+    }
+    return this->last_bits_;
+  }
+  // Set the pixels [x_start, x_end) of panel line y, which has to be in the band, to a panel colour.
+  void write_span_(int x_start, int x_end, int y, uint8_t bits);
+
+  Color last_color_{};
+  uint8_t last_bits_{0};
+  bool dither_{false};
+  uint8_t render_bands_{1};
+  // lines of the panel currently held in the buffer
+  int band_top_{0};
+  int band_bottom_{0};
+#ifdef USE_ESP32
+  bool parallel_transmit_{false};
+  BandTransmitter *transmitter_{nullptr};
+#endif
 };
 
 class WaveshareEPaper2P13InDKE : public WaveshareEPaper {
@@ -1096,6 +1444,7 @@ class WaveshareEPaper2P13InV3 : public WaveshareEPaper {
     // COMMAND POWER DOWN
     this->command(0x10);
     this->data(0x01);
+    this->invalidate_lut_();
     // cannot wait until idle here, the device no longer responds
   }
 
@@ -1110,10 +1459,12 @@ class WaveshareEPaper2P13InV3 : public WaveshareEPaper {
   int get_height_internal() override;
   uint32_t idle_timeout_() override;
 
-  void write_buffer_(uint8_t cmd, int top, int bottom);
-  void set_window_(int t, int b);
+  void write_buffer_(uint8_t cmd, const FrameWindow &window);
+  void set_window_(const FrameWindow &window);
   void send_reset_();
   void partial_update_();
+  // Send the window and start a partial refresh, the partial LUT has to be loaded.
+  void write_partial_(const FrameWindow &window);
   void full_update_();
 
   uint32_t full_update_every_{30};
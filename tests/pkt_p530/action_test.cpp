@@ -0,0 +1,115 @@
+// Stopping actions while their requests are in flight: a stopped action is not finished by late replies, and a
+// stopped feed still closes the door it opened.
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "fake_mcu.h"
+#include "pkt_p530/automation.h"
+
+using namespace esphome;
+using namespace esphome::pkt_p530;
+using testing::FakeMcu;
+
+namespace {
+
+// Runs an action as the only one of a script and records how it finished
+template<typename A> struct Script {
+  explicit Script(P530Component *parent) {
+    this->action.set_parent(parent);
+    this->action.add_on_complete({new LambdaAction<>([this]() { this->events.push_back("complete"); })});
+    this->action.add_on_error({new LambdaAction<>([this]() { this->events.push_back("error"); })});
+    this->actions.add_actions({&this->action, new LambdaAction<>([this]() {
+                                 this->events.push_back("next");
+                                 this->finished_ms = millis();
+                               })});
+  }
+
+  A action;
+  ActionList<> actions;
+  std::vector<std::string> events;
+  uint32_t finished_ms{0};
+};
+
+void run(P530Component &component, FakeMcu &mcu, uint32_t ms) {
+  for (uint32_t t = 0; t < ms; t += 10) {
+    component.loop();
+    mcu.step();
+    testing::advance(10);
+  }
+}
+
+std::string describe(const char *name, const std::vector<std::pair<uint8_t, uint8_t>> &transmissions,
+                     const std::vector<std::string> &events) {
+  std::string s = std::string(name) + ": sent";
+  char type[8];
+  for (const auto &t : transmissions) {
+    snprintf(type, sizeof(type), " %02X", t.first);
+    s += type;
+  }
+  s += ", events";
+  for (const auto &e : events)
+    s += " " + e;
+  return s;
+}
+
+std::vector<uint8_t> sent_types(const FakeMcu &mcu) {
+  std::vector<uint8_t> types;
+  for (const auto &t : mcu.transmissions)
+    types.push_back(t.first);
+  return types;
+}
+
+const uint8_t OPEN = static_cast<uint8_t>(ReqType::OPEN_DOOR);
+const uint8_t CLOSE = static_cast<uint8_t>(ReqType::CLOSE_DOOR);
+const uint8_t DISPENSE = static_cast<uint8_t>(ReqType::DISPENSE);
+
+void check_stop_feed(const char *name, uint32_t stop_after_ms, const std::vector<uint8_t> &expected) {
+  P530Component component;
+  FakeMcu mcu;
+  component.set_uart_parent(&mcu.uart);
+  mcu.report_delay_ms = 1000;
+  Script<FeedAction<>> script(&component);
+  script.action.set_portions(1);
+
+  script.actions.play();
+  run(component, mcu, stop_after_ms);
+  script.actions.stop();
+  run(component, mcu, 20000);
+
+  testing::expect(sent_types(mcu) == expected && script.events.empty(),
+                  describe(name, mcu.transmissions, script.events));
+}
+
+// A reply to the stopped run must not finish the next one
+void check_restart_door() {
+  P530Component component;
+  FakeMcu mcu;
+  component.set_uart_parent(&mcu.uart);
+  mcu.report_delay_ms = 2000;
+  Script<DoorOpenAction<>> script(&component);
+
+  script.actions.play();
+  run(component, mcu, 500);
+  script.actions.stop();
+  script.actions.play();
+  const uint32_t restarted_ms = millis();
+  run(component, mcu, 5000);
+
+  testing::expect(script.events == std::vector<std::string>{"complete", "next"} &&
+                      script.finished_ms >= restarted_ms + mcu.report_delay_ms,
+                  describe("restarted door", mcu.transmissions, script.events) + " after " +
+                      std::to_string(script.finished_ms - restarted_ms) + "ms");
+}
+
+}  // namespace
+
+int main() {
+  check_stop_feed("stop while opening", 500, {OPEN, CLOSE});
+  check_stop_feed("stop while dispensing", 1500, {OPEN, DISPENSE, CLOSE});
+  check_stop_feed("stop while closing", 2500, {OPEN, DISPENSE, CLOSE});
+  check_restart_door();
+
+  printf("action_test: %s\n", testing::failures() == 0 ? "ok" : "FAILED");
+  return testing::failures() == 0 ? 0 : 1;
+}
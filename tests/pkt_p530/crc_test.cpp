@@ -0,0 +1,62 @@
+// Checks the table-driven crc16_update() against the bitwise CRC and measures both on the host. The host numbers
+// only show the ratio, the ESP8266 reads the table from flash.
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "fake_uart.h"
+#include "pkt_p530/crc16.h"
+
+using namespace esphome;
+using namespace esphome::pkt_p530;
+
+namespace {
+
+template<typename F> double mb_per_s(const std::vector<uint8_t> &data, int rounds, F &&crc) {
+  volatile uint16_t sink = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; i++)
+    sink = crc(data);
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  (void) sink;
+  return double(data.size()) * rounds / elapsed.count() / 1e6;
+}
+
+}  // namespace
+
+int main() {
+  // CRC-16/CCITT-FALSE check value
+  static const uint8_t CHECK[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  testing::expect(crc16_update(CRC16_INIT, CHECK, sizeof(CHECK)) == 0x29B1, "check value 0x29B1");
+
+  std::mt19937 rng(46);
+  for (int round = 0; round < 10000; round++) {
+    std::vector<uint8_t> data(rng() % 256);
+    for (auto &byte : data)
+      byte = rng();
+    const uint16_t init = round % 2 == 0 ? CRC16_INIT : rng();
+    const uint16_t expected = testing::crc16_bitwise(init, data.data(), data.size());
+    testing::expect(crc16_update(init, data.data(), data.size()) == expected, "table CRC differs from bitwise");
+
+    // byte by byte, as the receive path updates it
+    uint16_t crc = init;
+    for (uint8_t byte : data)
+      crc = crc16_update(crc, byte);
+    testing::expect(crc == expected, "incremental CRC differs from bitwise");
+  }
+
+  // packets are at most 255 bytes
+  std::vector<uint8_t> packet(255);
+  for (auto &byte : packet)
+    byte = rng();
+  const double table =
+      mb_per_s(packet, 200000, [](const std::vector<uint8_t> &d) { return crc16_update(CRC16_INIT, d.data(), d.size()); });
+  const double bitwise = mb_per_s(packet, 200000, [](const std::vector<uint8_t> &d) {
+    return testing::crc16_bitwise(CRC16_INIT, d.data(), d.size());
+  });
+  printf("crc16: table %.0f MB/s, bitwise %.0f MB/s (%.1fx)\n", table, bitwise, table / bitwise);
+
+  printf("crc_test: %s\n", testing::failures() == 0 ? "ok" : "FAILED");
+  return testing::failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+#include "fake_mcu.h"
+
+#include "esphome/core/hal.h"
+#include "pkt_p530/protocol.h"
+
+namespace esphome {
+namespace testing {
+
+using pkt_p530::ReportType;
+using pkt_p530::ReqType;
+
+void FakeMcu::step() {
+  for (const auto &packet : this->uart.take_packets()) {
+    const int n = static_cast<int>(this->transmissions.size());
+    const uint8_t type = packet[3];
+    const uint8_t seq = packet[4];
+    this->transmissions.emplace_back(type, seq);
+    if (this->drop(n))
+      continue;
+
+    this->uart.receive(make_packet(type, seq, {0x01}));
+    const uint32_t due = millis() + this->report_delay_ms;
+    switch (static_cast<ReqType>(type)) {
+      case ReqType::OPEN_DOOR:
+        this->reports_.push_back({due, make_packet(static_cast<uint8_t>(ReportType::DOOR_OPEN_DONE), seq, {0x02})});
+        break;
+      case ReqType::CLOSE_DOOR:
+        this->reports_.push_back({due, make_packet(static_cast<uint8_t>(ReportType::DOOR_CLOSE_DONE), seq, {0x02})});
+        break;
+      case ReqType::DISPENSE:
+        this->reports_.push_back(
+            {due, make_packet(static_cast<uint8_t>(ReportType::DISPENSE_DONE), seq, {packet[5], 0x00, 0x01})});
+        break;
+      default:
+        break;
+    }
+  }
+
+  for (auto it = this->reports_.begin(); it != this->reports_.end();) {
+    if (static_cast<int32_t>(millis() - it->due) < 0) {
+      ++it;
+      continue;
+    }
+    this->uart.receive(it->packet);
+    it = this->reports_.erase(it);
+  }
+}
+
+}  // namespace testing
+}  // namespace esphome
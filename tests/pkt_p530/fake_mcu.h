@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "fake_uart.h"
+
+namespace esphome {
+namespace testing {
+
+// The MCU behind the UART: ACKs every request and sends the final report of door and dispense requests after
+// report_delay_ms. Call step() after the component's loop().
+class FakeMcu {
+ public:
+  void step();
+
+  FakeUart uart;
+  // drop the replies to the n-th transmission (counting from 0)?
+  std::function<bool(int)> drop = [](int) { return false; };
+  uint32_t report_delay_ms{0};
+  // type and seq of every packet the component wrote
+  std::vector<std::pair<uint8_t, uint8_t>> transmissions;
+
+ protected:
+  struct Report {
+    uint32_t due;
+    std::vector<uint8_t> packet;
+  };
+  std::vector<Report> reports_;
+};
+
+}  // namespace testing
+}  // namespace esphome
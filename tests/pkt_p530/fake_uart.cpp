@@ -0,0 +1,62 @@
+#include "fake_uart.h"
+
+#include <cstdio>
+
+namespace esphome {
+namespace testing {
+
+static int num_failures = 0;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+void FakeUart::write_array(const uint8_t *data, size_t len) { this->tx.insert(this->tx.end(), data, data + len); }
+
+bool FakeUart::read_array(uint8_t *data, size_t len) {
+  if (this->rx_.size() < len)
+    return false;
+  for (size_t i = 0; i < len; i++) {
+    data[i] = this->rx_.front();
+    this->rx_.pop_front();
+  }
+  return true;
+}
+
+std::vector<std::vector<uint8_t>> FakeUart::take_packets() {
+  std::vector<std::vector<uint8_t>> packets;
+  size_t pos = 0;
+  while (pos + 3 <= this->tx.size() && this->tx[pos + 2] > 0 && pos + this->tx[pos + 2] <= this->tx.size()) {
+    packets.emplace_back(this->tx.begin() + pos, this->tx.begin() + pos + this->tx[pos + 2]);
+    pos += this->tx[pos + 2];
+  }
+  this->tx.erase(this->tx.begin(), this->tx.begin() + pos);
+  return packets;
+}
+
+uint16_t crc16_bitwise(uint16_t crc, const uint8_t *data, size_t len) {
+  while (len--) {
+    crc ^= *data++ << 8;
+    for (uint8_t bit = 0; bit < 8; bit++)
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+std::vector<uint8_t> make_packet(uint8_t type, uint8_t seq, const std::vector<uint8_t> &payload) {
+  std::vector<uint8_t> packet;
+  packet.reserve(payload.size() + 7);
+  packet.insert(packet.end(), {0xAA, 0xAA, static_cast<uint8_t>(payload.size() + 7), type, seq});
+  packet.insert(packet.end(), payload.begin(), payload.end());
+  const uint16_t crc = crc16_bitwise(0xFFFF, packet.data(), packet.size());
+  packet.push_back(crc >> 8);
+  packet.push_back(crc & 0xFF);
+  return packet;
+}
+
+void expect(bool condition, const std::string &message) {
+  if (!condition) {
+    fprintf(stderr, "FAIL: %s\n", message.c_str());
+    num_failures++;
+  }
+}
+int failures() { return num_failures; }
+
+}  // namespace testing
+}  // namespace esphome
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "esphome/components/uart/uart.h"
+
+namespace esphome {
+namespace testing {
+
+// Stands in for the UART to the MCU: bytes written by the component are collected in tx, bytes pushed with
+// receive() are read by the component.
+class FakeUart : public uart::UARTComponent {
+ public:
+  void write_array(const uint8_t *data, size_t len) override;
+  bool read_array(uint8_t *data, size_t len) override;
+  int available() override { return static_cast<int>(this->rx_.size()); }
+
+  void receive(const std::vector<uint8_t> &data) { this->rx_.insert(this->rx_.end(), data.begin(), data.end()); }
+  // Split tx into packets, assuming the component only writes whole packets
+  std::vector<std::vector<uint8_t>> take_packets();
+
+  std::vector<uint8_t> tx;
+
+ protected:
+  std::deque<uint8_t> rx_;
+};
+
+// Bitwise CRC-16/CCITT-FALSE, the reference the table-driven crc16_update() is checked against
+uint16_t crc16_bitwise(uint16_t crc, const uint8_t *data, size_t len);
+
+// A packet as the MCU sends it, with the CRC computed by crc16_bitwise()
+std::vector<uint8_t> make_packet(uint8_t type, uint8_t seq, const std::vector<uint8_t> &payload);
+
+// Count a failed check, main() returns the failures as exit code
+void expect(bool condition, const std::string &message);
+int failures();
+
+}  // namespace testing
+}  // namespace esphome
@@ -0,0 +1,204 @@
+// Fuzzer of the pkt_p530 receive path. Valid packets are mixed with junk, packets with a bad CRC, truncated packets
+// and false packet starts; every valid packet has to come out of the parser exactly once and in order. The bytes
+// arrive either at once or in random fragments, with loop() running in between like on the device.
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fake_uart.h"
+#include "pkt_p530/p530_component.h"
+
+using namespace esphome;
+using namespace esphome::pkt_p530;
+
+namespace {
+
+// not used by the protocol, so nothing but the test waiter looks at it
+const uint8_t TEST_TYPE = 0x30;
+
+class TestComponent : public P530Component {
+ public:
+  using P530Component::crc_errors_;
+  using P530Component::framing_errors_;
+  using P530Component::resync_bytes_;
+  using P530Component::rx_crc_len_;
+  using P530Component::rx_len_;
+};
+
+struct Receiver {
+  explicit Receiver(TestComponent &component) {
+    component.add_report_waiter(TEST_TYPE, 0, 0, [this](ErrorCode err, std::span<const uint8_t> payload) {
+      this->ids.push_back(payload.size() >= 2 ? (payload[0] << 8) | payload[1] : -1);
+      // rejecting keeps the waiter registered
+      return false;
+    });
+  }
+  std::vector<int> ids;
+};
+
+std::vector<uint8_t> valid_packet(std::mt19937 &rng, int id) {
+  std::vector<uint8_t> payload{static_cast<uint8_t>(id >> 8), static_cast<uint8_t>(id)};
+  const size_t extra = rng() % 24;
+  for (size_t i = 0; i < extra; i++)
+    payload.push_back(rng() % 4 == 0 ? 0xAA : rng());
+  return testing::make_packet(TEST_TYPE, id % 254 + 1, payload);
+}
+
+// Let the component run for ms without new bytes
+void idle(TestComponent &component, uint32_t ms) {
+  for (uint32_t i = 0; i < ms; i++) {
+    testing::advance(1);
+    component.loop();
+  }
+}
+
+// A false start is dropped once nothing arrived for RX_FRAME_TIMEOUT_MS, not earlier
+void check_stale_frame_drop() {
+  testing::FakeUart uart;
+  TestComponent component;
+  component.set_uart_parent(&uart);
+  Receiver receiver(component);
+
+  uart.receive({0xAA, 0xAA, 0xFF, 0x01, 0x02});
+  idle(component, RX_FRAME_TIMEOUT_MS - 10);
+  testing::expect(component.rx_len_ == 5, "false start dropped before the frame timeout");
+  idle(component, 20);
+  testing::expect(component.rx_len_ == 0, "false start kept after the frame timeout");
+  testing::expect(component.framing_errors_ == 1, "stale frame not counted as framing error");
+
+  // the next packet is handled as soon as it arrived
+  uart.receive(testing::make_packet(TEST_TYPE, 1, {0x00, 0x07}));
+  component.loop();
+  testing::expect(receiver.ids == std::vector<int>{7}, "packet after a stale false start not received");
+}
+
+// A truncated packet followed by a complete one: the CRC fails and the rescan finds the second packet in the
+// retained bytes, without waiting for the frame timeout
+void check_truncated_frame() {
+  testing::FakeUart uart;
+  TestComponent component;
+  component.set_uart_parent(&uart);
+  Receiver receiver(component);
+
+  std::vector<uint8_t> truncated = testing::make_packet(TEST_TYPE, 1, {0x00, 0x01, 0x10, 0x20, 0x30});
+  truncated.resize(8);
+  uart.receive(truncated);
+  uart.receive(testing::make_packet(TEST_TYPE, 2, {0x00, 0x02, 0x11, 0x22, 0x33, 0x44, 0x55}));
+  component.loop();
+  testing::expect(receiver.ids == std::vector<int>{2}, "packet after a truncated one not received");
+  testing::expect(component.crc_errors_ == 1, "truncated packet not counted as CRC error");
+  testing::expect(component.resync_bytes_ == truncated.size(), "resync did not drop exactly the truncated packet");
+}
+
+// One byte per loop(): the partial packet and its CRC are kept between the calls, and the packet is handled in the
+// loop() its last byte arrived in
+void check_byte_by_byte() {
+  testing::FakeUart uart;
+  TestComponent component;
+  component.set_uart_parent(&uart);
+  Receiver receiver(component);
+
+  const std::vector<uint8_t> packet = testing::make_packet(TEST_TYPE, 1, {0x00, 0x03, 0xAA, 0xAA, 0x09});
+  for (size_t i = 0; i < packet.size(); i++) {
+    uart.receive({packet[i]});
+    component.loop();
+    testing::advance(1);
+    if (i + 1 < packet.size()) {
+      testing::expect(component.rx_len_ == i + 1, "partial packet not kept at byte " + std::to_string(i));
+      // the CRC starts once the length is known and does not cover the CRC bytes
+      const size_t crc_len = i < 2 ? 0 : std::min<size_t>(i + 1, packet.size() - PACKET_CRC_SIZE);
+      testing::expect(component.rx_crc_len_ == crc_len, "CRC not updated with byte " + std::to_string(i));
+      testing::expect(receiver.ids.empty(), "packet handled before it was complete");
+    }
+  }
+  testing::expect(receiver.ids == std::vector<int>{3}, "packet sent byte by byte not received");
+  testing::expect(component.rx_len_ == 0, "bytes left after the packet");
+}
+
+void fuzz(uint32_t seed, int rounds, bool fragment) {
+  testing::FakeUart uart;
+  TestComponent component;
+  component.set_uart_parent(&uart);
+  Receiver receiver(component);
+  std::mt19937 rng(seed);
+
+  std::vector<int> expected;
+  int id = 0;
+  for (int round = 0; round < rounds; round++) {
+    std::vector<uint8_t> stream;
+    const int elements = 1 + rng() % 6;
+    for (int e = 0; e < elements; e++) {
+      std::vector<uint8_t> packet = valid_packet(rng, ++id);
+      switch (rng() % 6) {
+        case 0:  // junk, often with packet start bytes
+        case 1: {
+          const size_t junk = 1 + rng() % 8;
+          for (size_t i = 0; i < junk; i++)
+            stream.push_back(rng() % 3 == 0 ? 0xAA : rng());
+          break;
+        }
+        case 2:  // bad CRC, the corrupted byte may be the length as well
+          packet[2 + rng() % (packet.size() - 2)] ^= 1 << (rng() % 8);
+          stream.insert(stream.end(), packet.begin(), packet.end());
+          continue;
+        case 3:  // truncated
+          packet.resize(1 + rng() % (packet.size() - 1));
+          stream.insert(stream.end(), packet.begin(), packet.end());
+          continue;
+        default:
+          break;
+      }
+      packet = valid_packet(rng, id);
+      stream.insert(stream.end(), packet.begin(), packet.end());
+      expected.push_back(id);
+    }
+
+    if (fragment) {
+      for (size_t pos = 0; pos < stream.size();) {
+        const size_t count = std::min<size_t>(1 + rng() % 8, stream.size() - pos);
+        uart.receive(std::vector<uint8_t>(stream.begin() + pos, stream.begin() + pos + count));
+        pos += count;
+        component.loop();
+        testing::advance(1);
+      }
+    } else {
+      uart.receive(stream);
+      component.loop();
+    }
+    // a false start at the end waits for the frame timeout
+    idle(component, RX_FRAME_TIMEOUT_MS + 10);
+  }
+
+  testing::expect(receiver.ids == expected, "seed " + std::to_string(seed) + ": received " +
+                                                std::to_string(receiver.ids.size()) + " of " +
+                                                std::to_string(expected.size()) + " packets or in the wrong order");
+  testing::expect(component.framing_errors_ > 0 && component.crc_errors_ > 0 && component.resync_bytes_ > 0,
+                  "counters not updated");
+  printf("seed %u%s: %zu packets, %u framing errors, %u CRC errors, %u resync bytes\n", seed,
+         fragment ? " fragmented" : "", expected.size(), component.framing_errors_, component.crc_errors_,
+         component.resync_bytes_);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  check_stale_frame_drop();
+  check_truncated_frame();
+  check_byte_by_byte();
+
+  // a seed on the command line reproduces a single run
+  if (argc > 1) {
+    fuzz(strtoul(argv[1], nullptr, 0), 2000, false);
+    fuzz(strtoul(argv[1], nullptr, 0), 2000, true);
+  } else {
+    for (uint32_t seed = 1; seed <= 5; seed++) {
+      fuzz(seed, 2000, false);
+      fuzz(seed, 2000, true);
+    }
+  }
+
+  printf("framer_fuzz: %s\n", testing::failures() == 0 ? "ok" : "FAILED");
+  return testing::failures() == 0 ? 0 : 1;
+}
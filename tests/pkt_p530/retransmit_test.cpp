@@ -0,0 +1,170 @@
+// Retransmission of unanswered requests, the timeouts learned from the replies and the pacing of writes to the TX
+// FIFO, against a simulated MCU that loses packets on request.
+#include <cstdio>
+#include <string>
+
+#include "fake_mcu.h"
+#include "pkt_p530/p530_component.h"
+
+using namespace esphome;
+using namespace esphome::pkt_p530;
+
+namespace {
+
+using testing::FakeMcu;
+
+class TestComponent : public P530Component {
+ public:
+  using P530Component::ack_rtt_;
+  using P530Component::in_flight_count_;
+  using P530Component::tx_failures_;
+};
+
+// Runs a one step transaction for run_ms and returns its result, -1 if it did not complete
+int run(TestComponent &component, FakeMcu &mcu, ReqType req, uint32_t ack_timeout_ms, uint32_t run_ms = 20000) {
+  const uint8_t payload[] = {0x01, 0x01, 0x01, 0x50};
+  const bool dispense = req == ReqType::DISPENSE;
+  Transaction transaction;
+  transaction.add_step(req, payload, sizeof(payload), 0, dispense ? ReportType::DISPENSE_DONE : ReportType::NONE,
+                       dispense ? 3000 : 0, dispense ? check_dispense_report : nullptr);
+  int result = -1;
+  component.run_transaction(transaction, ack_timeout_ms, [&result](ErrorCode err) { result = static_cast<int>(err); });
+  mcu.transmissions.clear();
+  for (uint32_t t = 0; t < run_ms; t += 10) {
+    component.loop();
+    mcu.step();
+    testing::advance(10);
+  }
+  return result;
+}
+
+std::string describe(const char *name, int result, size_t transmissions) {
+  return std::string(name) + ": result " + std::to_string(result) + ", " + std::to_string(transmissions) +
+         " transmissions";
+}
+
+void check_retransmission() {
+  TestComponent component;
+  FakeMcu mcu;
+  component.set_uart_parent(&mcu.uart);
+  component.set_max_retries(2);
+
+  // a lost ACK is recovered by retransmitting with the same seq
+  mcu.drop = [](int n) { return n == 0; };
+  int result = run(component, mcu, ReqType::LED_CTL, ACK_WAIT_LIMIT_MS);
+  testing::expect(result == 0 && mcu.transmissions.size() == 2 && mcu.transmissions[0] == mcu.transmissions[1],
+                  describe("one lost ACK", result, mcu.transmissions.size()));
+
+  // out of retries
+  mcu.drop = [](int) { return true; };
+  result = run(component, mcu, ReqType::LED_CTL, ACK_WAIT_LIMIT_MS);
+  testing::expect(result == static_cast<int>(ErrorCode::TIMEOUT) && mcu.transmissions.size() == 3,
+                  describe("no ACK", result, mcu.transmissions.size()));
+  testing::expect(component.in_flight_count_ == 0, "request still in flight after it failed");
+
+  // the measured ACK time replaces the initial retransmission timeout
+  mcu.drop = [](int) { return false; };
+  for (int i = 0; i < 5; i++)
+    run(component, mcu, ReqType::LED_CTL, ACK_WAIT_LIMIT_MS, 100);
+  testing::expect(component.ack_rtt_[static_cast<uint8_t>(ReqType::LED_CTL)].timeout(0, MIN_ACK_RTO_MS,
+                                                                                      MAX_ACK_RTO_MS) == MIN_ACK_RTO_MS,
+                  "ACK timeout not learned");
+}
+
+// Once the action gave up waiting for the ACK, the request must not be retransmitted anymore: a late door motion
+// after the automation reported the failure is worse than none
+void check_explicit_send_timeout() {
+  TestComponent component;
+  FakeMcu mcu;
+  component.set_uart_parent(&mcu.uart);
+  component.set_max_retries(2);
+  mcu.drop = [](int) { return true; };
+
+  // at the first retransmission timeout
+  int result = run(component, mcu, ReqType::OPEN_DOOR, INITIAL_ACK_RTO_MS);
+  testing::expect(result == static_cast<int>(ErrorCode::TIMEOUT) && mcu.transmissions.size() == 1,
+                  describe("send timeout 1s", result, mcu.transmissions.size()));
+  testing::expect(component.in_flight_count_ == 0, "request still in flight after its waiter expired");
+  testing::expect(component.tx_failures_ == 1, "expired request not counted as failure");
+
+  // between the first and the second retransmission
+  result = run(component, mcu, ReqType::OPEN_DOOR, 2500);
+  testing::expect(result == static_cast<int>(ErrorCode::TIMEOUT) && mcu.transmissions.size() == 2,
+                  describe("send timeout 2.5s", result, mcu.transmissions.size()));
+}
+
+void check_dispense() {
+  TestComponent component;
+  FakeMcu mcu;
+  component.set_uart_parent(&mcu.uart);
+  component.set_max_retries(2);
+
+  // never retransmitted, the MCU may have dispensed already
+  mcu.drop = [](int n) { return n == 0; };
+  int result = run(component, mcu, ReqType::DISPENSE, ACK_WAIT_LIMIT_MS);
+  testing::expect(result == static_cast<int>(ErrorCode::TIMEOUT) && mcu.transmissions.size() == 1,
+                  describe("dispense, lost ACK", result, mcu.transmissions.size()));
+
+  // fast dispenses do not shorten the configured timeout
+  mcu.drop = [](int) { return false; };
+  for (int i = 0; i < 5; i++)
+    run(component, mcu, ReqType::DISPENSE, ACK_WAIT_LIMIT_MS, 500);
+  testing::expect(component.get_completion_timeout(ReportType::DISPENSE_DONE, 2, 6000) == 6000,
+                  "fast dispenses shortened the configured timeout");
+
+  // slow ones extend it for more portions
+  mcu.report_delay_ms = 2500;
+  for (int i = 0; i < 5; i++) {
+    result = run(component, mcu, ReqType::DISPENSE, ACK_WAIT_LIMIT_MS, 4000);
+    testing::expect(result == 0, describe("slow dispense", result, mcu.transmissions.size()));
+  }
+  testing::expect(component.get_completion_timeout(ReportType::DISPENSE_DONE, 2, 3000) > 5000,
+                  "slow dispenses did not extend the timeout");
+}
+
+// Writes beyond the FIFO would block loop(), the packets wait in the queue instead
+void check_tx_fifo() {
+  TestComponent component;
+  FakeMcu mcu;
+  component.set_uart_parent(&mcu.uart);
+  component.set_max_in_flight(MAX_IN_FLIGHT_LIMIT);
+  mcu.uart.set_baud_rate(9600);  // about 1ms per byte
+
+  const uint8_t payload[12] = {};
+  for (uint8_t i = 0; i < TX_QUEUE_SIZE; i++)
+    component.send(ReqType::MOTOR_PARAMS, payload, sizeof(payload));
+  const size_t packet_len = sizeof(payload) + PACKET_MIN_SIZE;
+  const size_t fit = UART_TX_FIFO_SIZE / packet_len;
+  testing::expect(mcu.uart.tx.size() == fit * packet_len,
+                  "wrote " + std::to_string(mcu.uart.tx.size()) + " bytes into an empty FIFO");
+
+  // the next packet fits once this many bytes went out
+  const uint32_t us_per_byte = 10000000 / 9600;
+  const uint32_t drain = (fit + 1) * packet_len - UART_TX_FIFO_SIZE;
+  testing::advance_us(drain * us_per_byte - 1);
+  component.loop();
+  testing::expect(mcu.uart.tx.size() == fit * packet_len, "wrote before the FIFO had room");
+  testing::advance_us(1);
+  component.loop();
+  testing::expect(mcu.uart.tx.size() == (fit + 1) * packet_len, "did not write once the FIFO had room");
+
+  for (int i = 0; i < 100; i++) {
+    component.loop();
+    mcu.step();
+    testing::advance(10);
+  }
+  testing::expect(mcu.transmissions.size() == TX_QUEUE_SIZE,
+                  std::to_string(mcu.transmissions.size()) + " of " + std::to_string(TX_QUEUE_SIZE) + " packets sent");
+}
+
+}  // namespace
+
+int main() {
+  check_retransmission();
+  check_explicit_send_timeout();
+  check_dispense();
+  check_tx_fifo();
+
+  printf("retransmit_test: %s\n", testing::failures() == 0 ? "ok" : "FAILED");
+  return testing::failures() == 0 ? 0 : 1;
+}
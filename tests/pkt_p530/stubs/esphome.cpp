@@ -0,0 +1,37 @@
+// Minimal host implementation of the ESPHome core parts used by pkt_p530: a simulated clock and logging.
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+#include <cstdarg>
+#include <cstdio>
+
+namespace esphome {
+
+int log_level = LOG_LEVEL_NONE;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+void esp_log_printf_(int level, const char *tag, const char *format, ...) {
+  if (level > log_level)
+    return;
+  fprintf(stderr, "[%s] ", tag);
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+namespace {
+// starts away from 0, the component treats some timestamps of 0 as unset
+uint64_t now_us = 1000000;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+}  // namespace
+
+uint32_t millis() { return static_cast<uint32_t>(now_us / 1000); }
+uint32_t micros() { return static_cast<uint32_t>(now_us); }
+void delay(uint32_t ms) { now_us += uint64_t(ms) * 1000; }
+
+namespace testing {
+void advance(uint32_t ms) { now_us += uint64_t(ms) * 1000; }
+void advance_us(uint32_t us) { now_us += us; }
+}  // namespace testing
+
+}  // namespace esphome
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace uart {
+
+enum UARTParityOptions { UART_CONFIG_PARITY_NONE, UART_CONFIG_PARITY_EVEN, UART_CONFIG_PARITY_ODD };
+
+// The bus, implemented by the harness, see testing::FakeUart
+class UARTComponent {
+ public:
+  virtual ~UARTComponent() = default;
+  virtual void write_array(const uint8_t *data, size_t len) = 0;
+  virtual bool read_array(uint8_t *data, size_t len) = 0;
+  virtual int available() = 0;
+  virtual void flush() {}
+  uint32_t get_baud_rate() const { return this->baud_rate_; }
+  void set_baud_rate(uint32_t baud_rate) { this->baud_rate_ = baud_rate; }
+
+ protected:
+  uint32_t baud_rate_{115200};
+};
+
+class UARTDevice {
+ public:
+  UARTDevice() = default;
+  UARTDevice(UARTComponent *parent) : parent_(parent) {}
+  void set_uart_parent(UARTComponent *parent) { this->parent_ = parent; }
+
+  void write_byte(uint8_t data) { this->parent_->write_array(&data, 1); }
+  void write_array(const uint8_t *data, size_t len) { this->parent_->write_array(data, len); }
+  bool read_byte(uint8_t *data) { return this->parent_->read_array(data, 1); }
+  bool read_array(uint8_t *data, size_t len) { return this->parent_->read_array(data, len); }
+  int available() { return this->parent_->available(); }
+  void flush() { this->parent_->flush(); }
+  void check_uart_settings(uint32_t baud_rate, uint8_t stop_bits = 1,
+                           UARTParityOptions parity = UART_CONFIG_PARITY_NONE, uint8_t data_bits = 8) {}
+
+ protected:
+  UARTComponent *parent_{nullptr};
+};
+
+}  // namespace uart
+}  // namespace esphome
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+
+template<typename... Ts> class ActionList;
+
+// Just enough of ESPHome's actions to run the pkt_p530 actions on the host: actions form a list, play_next_() plays
+// the next one in the list
+template<typename... Ts> class Action {
+ public:
+  virtual ~Action() = default;
+  virtual void play_complex(const Ts &...x) {
+    this->num_running_++;
+    this->play(x...);
+    this->play_next_(x...);
+  }
+  virtual void stop() {}
+  bool is_running() { return this->num_running_ > 0; }
+
+ protected:
+  friend class ActionList<Ts...>;
+  virtual void play(const Ts &...x) = 0;
+  void play_next_(const Ts &...x) {
+    if (this->num_running_ > 0) {
+      this->num_running_--;
+      if (this->next_ != nullptr)
+        this->next_->play_complex(x...);
+    }
+  }
+
+  Action<Ts...> *next_{nullptr};
+  int num_running_{0};
+};
+
+template<typename... Ts> class Condition {
+ public:
+  virtual ~Condition() = default;
+  virtual bool check(const Ts &...x) = 0;
+};
+
+template<typename... Ts> class ActionList {
+ public:
+  void add_action(Action<Ts...> *action) {
+    if (this->actions_end_ == nullptr) {
+      this->actions_begin_ = action;
+    } else {
+      this->actions_end_->next_ = action;
+    }
+    this->actions_end_ = action;
+  }
+  void add_actions(std::initializer_list<Action<Ts...> *> actions) {
+    for (auto *action : actions)
+      this->add_action(action);
+  }
+  void play(Ts... x) {
+    if (this->actions_begin_ != nullptr)
+      this->actions_begin_->play_complex(x...);
+  }
+  void stop() {
+    for (Action<Ts...> *action = this->actions_begin_; action != nullptr; action = action->next_)
+      action->stop();
+  }
+  bool empty() const { return this->actions_begin_ == nullptr; }
+
+ protected:
+  Action<Ts...> *actions_begin_{nullptr};
+  Action<Ts...> *actions_end_{nullptr};
+};
+
+template<typename... Ts> class LambdaAction : public Action<Ts...> {
+ public:
+  explicit LambdaAction(std::function<void(Ts...)> &&f) : f_(std::move(f)) {}
+
+ protected:
+  void play(const Ts &...x) override { this->f_(x...); }
+
+  std::function<void(Ts...)> f_;
+};
+
+template<typename T, typename... X> class TemplatableValue {
+ public:
+  TemplatableValue() = default;
+  TemplatableValue(T value) : value_(value) {}
+  T value(X... x) { return this->value_; }
+
+ protected:
+  T value_{};
+};
+
+#define TEMPLATABLE_VALUE(type, name) \
+ protected: \
+  TemplatableValue<type, Ts...> name##_{}; \
+\
+ public: \
+  template<typename V> void set_##name(V name) { this->name##_ = name; }
+
+}  // namespace esphome
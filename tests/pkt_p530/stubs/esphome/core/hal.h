@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#define PROGMEM
+#define HOT
+
+namespace esphome {
+
+// Simulated clock, only the harness advances it, see testing::advance()
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+
+inline uint8_t progmem_read_byte(const uint8_t *addr) { return *addr; }
+inline uint16_t progmem_read_uint16(const uint16_t *addr) { return *addr; }
+
+namespace testing {
+void advance(uint32_t ms);
+void advance_us(uint32_t us);
+}  // namespace testing
+
+}  // namespace esphome
@@ -0,0 +1,232 @@
+// Compares WaiterTable with the linear waiter list it replaced over random add/dispatch/expire operations and
+// measures both with many concurrent actions waiting for their ACKs and reports.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "fake_uart.h"
+#include "pkt_p530/p530_component.h"
+
+using namespace esphome;
+using namespace esphome::pkt_p530;
+
+namespace {
+
+// The previous implementation: a vector scanned on every packet, matched waiters moved out and rejected ones pushed
+// back
+class LinearWaiters {
+ public:
+  bool add(uint8_t type, uint8_t seq, uint32_t deadline_ms, ReportCallback &&callback) {
+    this->waiters_.push_back({type, seq, deadline_ms, std::move(callback)});
+    return true;
+  }
+
+  void dispatch(uint8_t type, uint8_t seq, std::span<const uint8_t> payload) {
+    std::vector<Waiter> matched;
+    for (auto it = this->waiters_.begin(); it != this->waiters_.end();) {
+      if (it->type != type || (it->seq != 0 && it->seq != seq)) {
+        ++it;
+        continue;
+      }
+      matched.push_back(std::move(*it));
+      it = this->waiters_.erase(it);
+    }
+    for (auto &waiter : matched) {
+      if (!waiter.callback(ErrorCode::OK, payload))
+        this->waiters_.push_back(std::move(waiter));
+    }
+  }
+
+  void expire(uint32_t now) {
+    std::vector<ReportCallback> expired;
+    for (auto it = this->waiters_.begin(); it != this->waiters_.end();) {
+      if (it->deadline_ms != 0 && static_cast<int32_t>(now - it->deadline_ms) >= 0) {
+        expired.push_back(std::move(it->callback));
+        it = this->waiters_.erase(it);
+        continue;
+      }
+      ++it;
+    }
+    for (auto &callback : expired)
+      callback(ErrorCode::TIMEOUT, {});
+  }
+
+  size_t size() const { return this->waiters_.size(); }
+
+ protected:
+  struct Waiter {
+    uint8_t type;
+    uint8_t seq;
+    uint32_t deadline_ms;
+    ReportCallback callback;
+  };
+  std::vector<Waiter> waiters_;
+};
+
+struct Call {
+  int id;
+  ErrorCode err;
+  bool operator<(const Call &other) const { return std::make_pair(this->id, this->err) < std::make_pair(other.id, other.err); }
+  bool operator==(const Call &other) const { return this->id == other.id && this->err == other.err; }
+};
+
+// Both tables see the same operations, the waiters called by each operation have to be the same. The order of the
+// calls within one operation differs (insertion vs. bucket and deadline order), so the calls are compared sorted.
+void compare_random(uint32_t seed, int steps) {
+  WaiterTable table;
+  LinearWaiters linear;
+  std::vector<Call> table_calls, linear_calls;
+  std::mt19937 rng(seed);
+  int next_id = 0;
+
+  for (int step = 0; step < steps; step++) {
+    const uint32_t now = 1000 + step;
+    switch (rng() % 3) {
+      case 0: {
+        if (linear.size() >= MAX_WAITERS)
+          break;
+        const uint8_t type = rng() % 3;
+        const uint8_t seq = rng() % 3;
+        const uint32_t deadline = rng() % 4 != 0 ? now + 1 + rng() % 50 : 0;
+        const int id = next_id++;
+        // a waiter waiting for a later report rejects the packets it sees, like a dispense in progress
+        const bool rejects = rng() % 4 == 0;
+        auto callback = [id, rejects](std::vector<Call> *calls) {
+          return [id, rejects, calls](ErrorCode err, std::span<const uint8_t>) {
+            calls->push_back({id, err});
+            return err != ErrorCode::OK || !rejects;
+          };
+        };
+        testing::expect(table.add(type, seq, deadline, callback(&table_calls)), "table full too early");
+        linear.add(type, seq, deadline, callback(&linear_calls));
+        break;
+      }
+      case 1: {
+        const uint8_t type = rng() % 3;
+        const uint8_t seq = rng() % 3;
+        table.dispatch(type, seq, {});
+        linear.dispatch(type, seq, {});
+        break;
+      }
+      default:
+        table.expire(now);
+        linear.expire(now);
+        break;
+    }
+
+    std::sort(table_calls.begin(), table_calls.end());
+    std::sort(linear_calls.begin(), linear_calls.end());
+    if (table_calls != linear_calls) {
+      testing::expect(false, "seed " + std::to_string(seed) + ": tables differ at step " + std::to_string(step));
+      return;
+    }
+    table_calls.clear();
+    linear_calls.clear();
+  }
+}
+
+// A waiter rejecting a packet while the other callbacks filled the table must not disappear silently
+void check_full_table_on_reject() {
+  WaiterTable table;
+  std::vector<Call> calls;
+  table.add(0x01, 1, 0, [&](ErrorCode err, std::span<const uint8_t>) {
+    calls.push_back({1, err});
+    if (err != ErrorCode::OK)
+      return true;
+    // takes the slot this waiter was removed from
+    table.add(0x02, 1, 0, [](ErrorCode, std::span<const uint8_t>) { return true; });
+    return false;
+  });
+  for (uint8_t i = 1; i < MAX_WAITERS; i++)
+    table.add(0x03, i, 0, [](ErrorCode, std::span<const uint8_t>) { return true; });
+
+  table.dispatch(0x01, 1, {});
+  testing::expect(calls.size() == 2 && calls[1].err == ErrorCode::SEND_FAILED,
+                  "waiter dropped without an error when the table was full");
+}
+
+// Concurrent actions, each waiting for its ACK and then for a report that is preceded by progress reports. Status
+// packets nobody waits for arrive in between, like on the device. The callbacks capture a pointer and an index, so
+// like the callbacks of the actions they fit into std::function's small buffer.
+template<typename Table> class Bench {
+ public:
+  explicit Bench(int actions) : stage_(actions, 0) {}
+
+  // ns per packet
+  double run(int rounds) {
+    const uint8_t progress[] = {0x01, 0x00, 0x00};
+    const uint8_t final_report[] = {0x01, 0x00, 0x01};
+    uint32_t packets = 0;
+
+    const auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < this->stage_.size(); i++)
+      this->start_action_(i);
+    for (int round = 0; round < rounds; round++) {
+      for (size_t i = 0; i < this->stage_.size(); i++) {
+        const uint8_t seq = i + 1;
+        this->now_++;
+        this->table_.dispatch(0x02, 0xFF, {});
+        switch (this->stage_[i]) {
+          case 0:
+            this->table_.dispatch(0x0B, seq, {});
+            break;
+          case 1:
+            this->table_.dispatch(0x0C, seq, {progress, sizeof(progress)});
+            this->table_.dispatch(0x0C, seq, {final_report, sizeof(final_report)});
+            packets++;
+            break;
+          default:
+            this->start_action_(i);
+            break;
+        }
+        packets += 2;
+        this->table_.expire(this->now_);
+      }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    testing::expect(this->done_ > 0, "benchmark actions did not complete");
+    return elapsed.count() * 1e9 / packets;
+  }
+
+ protected:
+  void start_action_(size_t i) {
+    this->stage_[i] = 0;
+    this->table_.add(0x0B, i + 1, this->now_ + 1000, [this, i](ErrorCode err, std::span<const uint8_t>) {
+      this->stage_[i] = 1;
+      this->table_.add(0x0C, i + 1, this->now_ + 5000, [this, i](ErrorCode err, std::span<const uint8_t> payload) {
+        if (err == ErrorCode::OK && payload.size() == 3 && payload[2] == 0x00)
+          return false;  // still dispensing
+        this->stage_[i] = 2;
+        this->done_++;
+        return true;
+      });
+      return true;
+    });
+  }
+
+  Table table_;
+  std::vector<uint8_t> stage_;
+  uint32_t now_{1000};
+  uint32_t done_{0};
+};
+
+}  // namespace
+
+int main() {
+  check_full_table_on_reject();
+  for (uint32_t seed = 1; seed <= 5; seed++)
+    compare_random(seed, 200000);
+
+  // the table holds MAX_WAITERS, every action has one waiter at a time
+  const int actions = MAX_WAITERS - 1;
+  const double table_ns = Bench<WaiterTable>(actions).run(20000);
+  const double linear_ns = Bench<LinearWaiters>(actions).run(20000);
+  printf("waiters, %d concurrent actions: table %.0f ns/packet, linear %.0f ns/packet (%.1fx)\n", actions, table_ns,
+         linear_ns, linear_ns / table_ns);
+
+  printf("waiter_test: %s\n", testing::failures() == 0 ? "ok" : "FAILED");
+  return testing::failures() == 0 ? 0 : 1;
+}
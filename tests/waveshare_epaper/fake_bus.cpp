@@ -0,0 +1,119 @@
+#include "fake_bus.h"
+
+#include <cstdio>
+
+#include "esphome/components/spi/spi.h"
+#include "esphome/core/hal.h"
+
+namespace esphome {
+namespace testing {
+
+static const size_t MAX_TRACED_RUN = 16;
+
+static FakeBus *current_bus = nullptr;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+void FakePin::digital_write(bool value) {
+  this->state_ = value;
+  if (this->traced_ && FakeBus::current() != nullptr)
+    FakeBus::current()->pin_write(this->name_, value);
+}
+
+bool FakeBusyPin::digital_read() {
+  const bool busy = this->is_busy();
+  if (busy) {
+    this->waiting_ = true;
+  } else if (this->waiting_) {
+    this->waiting_ = false;
+    if (FakeBus::current() != nullptr)
+      FakeBus::current()->note("BUSY " + std::to_string(millis() - this->busy_start_) + " ms");
+  }
+  return busy;
+}
+void FakeBusyPin::set_busy_for(uint32_t ms) {
+  const uint32_t until = millis() + ms;
+  if (!this->is_busy()) {
+    this->busy_start_ = millis();
+    this->busy_until_ = until;
+  } else if (static_cast<int32_t>(until - this->busy_until_) > 0) {
+    this->busy_until_ = until;
+  }
+}
+bool FakeBusyPin::is_busy() const { return static_cast<int32_t>(this->busy_until_ - millis()) > 0; }
+
+FakeBus::FakeBus(FakePin *dc, ControllerModel *model) : dc_(dc), model_(model) { current_bus = this; }
+FakeBus::~FakeBus() {
+  if (current_bus == this)
+    current_bus = nullptr;
+}
+FakeBus *FakeBus::current() { return current_bus; }
+
+void FakeBus::enable() {
+  if (this->selected_)
+    this->nested_enables_++;
+  this->selected_ = true;
+}
+void FakeBus::disable() {
+  this->flush_run_();
+  if (!this->line_.empty())
+    this->note(this->line_);
+  this->line_.clear();
+  this->selected_ = false;
+}
+void FakeBus::write(const uint8_t *data, size_t length) {
+  if (!this->selected_) {
+    this->note("ERROR write without CS");
+    return;
+  }
+  // D/C is sampled with every byte
+  const bool dc = this->dc_->state();
+  if (!this->run_.empty() && dc != this->run_dc_)
+    this->flush_run_();
+  this->run_dc_ = dc;
+  for (size_t i = 0; i < length; i++) {
+    this->run_.push_back(data[i]);
+    if (dc) {
+      this->model_->on_data(data[i]);
+    } else {
+      this->model_->on_command(data[i]);
+    }
+  }
+}
+void FakeBus::pin_write(const char *name, bool value) {
+  this->note(std::string("PIN ") + name + (value ? " 1" : " 0"));
+}
+void FakeBus::note(const std::string &line) {
+  this->trace_ += line;
+  this->trace_ += '\n';
+}
+void FakeBus::flush_run_() {
+  if (this->run_.empty())
+    return;
+  char buf[48];
+  if (!this->line_.empty())
+    this->line_ += " | ";
+  this->line_ += this->run_dc_ ? "D" : "C";
+  if (this->run_.size() > MAX_TRACED_RUN) {
+    uint32_t hash = 2166136261UL;
+    for (uint8_t byte : this->run_)
+      hash = (hash ^ byte) * 16777619UL;
+    snprintf(buf, sizeof(buf), " [%zu bytes fnv 0x%08X]", this->run_.size(), hash);
+    this->line_ += buf;
+  } else {
+    for (uint8_t byte : this->run_) {
+      snprintf(buf, sizeof(buf), " %02X", byte);
+      this->line_ += buf;
+    }
+  }
+  this->run_.clear();
+}
+
+}  // namespace testing
+
+namespace spi {
+
+void fake_bus_enable() { testing::FakeBus::current()->enable(); }
+void fake_bus_disable() { testing::FakeBus::current()->disable(); }
+void fake_bus_write(const uint8_t *data, size_t length) { testing::FakeBus::current()->write(data, length); }
+
+}  // namespace spi
+}  // namespace esphome
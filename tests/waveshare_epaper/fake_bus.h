@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "esphome/core/gpio.h"
+
+namespace esphome {
+namespace testing {
+
+// Advances the simulated clock by ms, running the component timeouts and intervals that become due
+void run_scheduler(uint32_t ms);
+
+// Output pin, writes of traced pins show up in the trace. D/C is not traced, it is part of the C/D runs.
+class FakePin : public GPIOPin {
+ public:
+  explicit FakePin(const char *name, bool traced = true) : name_(name), traced_(traced) {}
+  void digital_write(bool value) override;
+  bool digital_read() override { return this->state_; }
+  bool state() const { return this->state_; }
+
+ protected:
+  const char *name_;
+  bool traced_;
+  bool state_{false};
+};
+
+// Busy output of the controller, high until the time set by the controller model. Once the driver sees it idle again
+// after a wait, the trace gets the time from the start of the busy period until then.
+class FakeBusyPin : public GPIOPin {
+ public:
+  bool digital_read() override;
+  void set_busy_for(uint32_t ms);
+  bool is_busy() const;
+
+ protected:
+  uint32_t busy_start_{0};
+  uint32_t busy_until_{0};
+  // the driver saw the pin busy and has not yet seen it idle
+  bool waiting_{false};
+};
+
+// What the panel controller does with the bytes, see Ssd168xModel
+class ControllerModel {
+ public:
+  virtual ~ControllerModel() = default;
+  virtual void on_command(uint8_t command) = 0;
+  virtual void on_data(uint8_t data) = 0;
+};
+
+// Stands in for the SPI bus of the display. Every CS assertion becomes one trace line with the command (C) and data
+// (D) runs in the order they were sent; long data runs are shortened to their length and FNV-1a hash.
+class FakeBus {
+ public:
+  FakeBus(FakePin *dc, ControllerModel *model);
+  ~FakeBus();
+
+  void enable();
+  void disable();
+  void write(const uint8_t *data, size_t length);
+  void pin_write(const char *name, bool value);
+
+  // Adds a line to the trace, e.g. to separate the steps of a scenario
+  void note(const std::string &line);
+  const std::string &get_trace() const { return this->trace_; }
+  // Number of CS assertions with the driver still holding another one, should stay 0
+  uint32_t get_nested_enables() const { return this->nested_enables_; }
+
+  static FakeBus *current();
+
+ protected:
+  void flush_run_();
+
+  FakePin *dc_;
+  ControllerModel *model_;
+  std::string trace_;
+  std::string line_;
+  bool selected_{false};
+  uint32_t nested_enables_{0};
+  // the data/command run being collected
+  bool run_dc_{false};
+  std::vector<uint8_t> run_;
+};
+
+}  // namespace testing
+}  // namespace esphome
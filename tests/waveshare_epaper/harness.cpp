@@ -0,0 +1,273 @@
+// Host test harness of the waveshare_epaper drivers. A scenario runs a driver against the fake SPI bus and GPIO pins
+// in fake_bus.h, checks the panel RAM decoded by a controller model against what was drawn and compares the bus trace
+// with the golden trace in traces/. Run with --update to rewrite the golden traces after an intended change.
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "esphome/core/log.h"
+#include "waveshare_epaper/waveshare_epaper.h"
+#include "fake_bus.h"
+#include "ssd168x_model.h"
+
+using namespace esphome;
+using esphome::testing::FakeBus;
+using esphome::testing::FakeBusyPin;
+using esphome::testing::FakePin;
+
+namespace {
+
+struct Box {
+  int x, y, w, h;
+};
+
+// Two boxes per frame, frame 2 and 3 are the same so the third update must be skipped
+const Box FRAMES[][2] = {
+    {{0, 0, 128, 4}, {10, 20, 40, 30}},
+    {{60, 100, 30, 50}, {0, 290, 128, 6}},
+    {{60, 100, 30, 50}, {0, 290, 128, 6}},
+};
+
+bool in_frame(int frame, int x, int y) {
+  for (const Box &box : FRAMES[frame]) {
+    if (x >= box.x && x < box.x + box.w && y >= box.y && y < box.y + box.h)
+      return true;
+  }
+  return false;
+}
+
+std::string stats_line(const waveshare_epaper::SPIStats &stats) {
+  char buf[128];
+  snprintf(buf, sizeof(buf), "TOTAL %u commands, %u transactions, %u bytes, %u ms busy", stats.commands,
+           stats.transactions, stats.bytes, stats.busy_time);
+  return buf;
+}
+
+int failures = 0;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+void expect(bool condition, const std::string &message) {
+  if (!condition) {
+    fprintf(stderr, "FAIL: %s\n", message.c_str());
+    failures++;
+  }
+}
+
+// 2.9" V2 in TypeA: full update, partial update, skipped unchanged frame
+std::string run_typea_2_9_v2() {
+  FakePin dc("dc", false), reset("reset");
+  FakeBusyPin busy;
+  testing::Ssd168xModel model(128, 296, &busy);
+  FakeBus bus(&dc, &model);
+
+  waveshare_epaper::WaveshareEPaperTypeA display(waveshare_epaper::WAVESHARE_EPAPER_2_9_IN_V2);
+  display.set_dc_pin(&dc);
+  display.set_reset_pin(&reset);
+  display.set_busy_pin(&busy);
+  display.set_full_update_every(2);
+  display.set_skip_unchanged(true);
+  int frame = 0;
+  display.set_writer([&frame](display::Display &it) {
+    for (const Box &box : FRAMES[frame])
+      it.filled_rectangle(box.x, box.y, box.w, box.h);
+  });
+
+  bus.note("# setup");
+  display.setup();
+  testing::run_scheduler(100);
+
+  for (frame = 0; frame < 3; frame++) {
+    bus.note("# frame " + std::to_string(frame + 1));
+    const uint32_t refreshes = model.get_refreshes();
+    display.update();
+    testing::run_scheduler(2000);
+    bus.note(stats_line(display.get_spi_stats()));
+
+    expect(model.get_refreshes() == refreshes + (frame < 2 ? 1 : 0),
+           "frame " + std::to_string(frame + 1) + ": unexpected number of refreshes");
+    int wrong = 0;
+    for (int y = 0; y < 296; y++) {
+      for (int x = 0; x < 128; x++) {
+        if (model.is_black(0x24, x, y) != in_frame(frame, x, y))
+          wrong++;
+      }
+    }
+    expect(wrong == 0, "frame " + std::to_string(frame + 1) + ": " + std::to_string(wrong) + " wrong pixels in RAM");
+  }
+  expect(bus.get_nested_enables() == 0, "CS asserted twice");
+  return bus.get_trace();
+}
+
+// 2.13" V3: an update arriving while a partial update waits for the reset and LUT must not change the frame being
+// sent. Frame 1 is a full update, frame 2 a partial one interrupted by frame 3, which is skipped and sent afterwards.
+const Box FRAMES_2_13[][2] = {
+    {{0, 0, 122, 4}, {10, 20, 40, 30}},
+    {{60, 100, 30, 50}, {0, 240, 122, 6}},
+    {{0, 100, 122, 50}, {5, 5, 20, 20}},
+};
+
+std::string run_2_13_v3_partial() {
+  FakePin dc("dc", false), reset("reset");
+  FakeBusyPin busy;
+  testing::Ssd168xModel model(128, 250, &busy);
+  FakeBus bus(&dc, &model);
+
+  waveshare_epaper::WaveshareEPaper2P13InV3 display;
+  display.set_dc_pin(&dc);
+  display.set_reset_pin(&reset);
+  display.set_busy_pin(&busy);
+  display.set_full_update_every(3);
+  int frame = 0;
+  display.set_writer([&frame](display::Display &it) {
+    for (const Box &box : FRAMES_2_13[frame])
+      it.filled_rectangle(box.x, box.y, box.w, box.h);
+  });
+
+  auto check_ram = [&model](int expected) {
+    int wrong = 0;
+    for (int y = 0; y < 250; y++) {
+      for (int x = 0; x < 122; x++) {
+        bool black = false;
+        for (const Box &box : FRAMES_2_13[expected])
+          black |= x >= box.x && x < box.x + box.w && y >= box.y && y < box.y + box.h;
+        if (model.is_black(0x24, x, y) != black)
+          wrong++;
+      }
+    }
+    expect(wrong == 0, "frame " + std::to_string(expected + 1) + ": " + std::to_string(wrong) + " wrong pixels in RAM");
+  };
+
+  bus.note("# setup");
+  display.setup();
+  testing::run_scheduler(200);
+
+  bus.note("# frame 1");
+  display.update();
+  testing::run_scheduler(2000);
+  check_ram(0);
+
+  bus.note("# frame 2, frame 3 during the reset");
+  frame = 1;
+  display.update();
+  testing::run_scheduler(150);
+  frame = 2;
+  display.update();
+  testing::run_scheduler(2000);
+  check_ram(1);
+
+  bus.note("# frame 3");
+  display.update();
+  testing::run_scheduler(2000);
+  check_ram(2);
+  bus.note(stats_line(display.get_spi_stats()));
+
+  expect(bus.get_nested_enables() == 0, "CS asserted twice");
+  return bus.get_trace();
+}
+
+// Gray levels 0 (black) to 3 (white) in 8x16 blocks, every level next to every other one
+uint8_t gray_pattern(int x, int y) { return (x / 8 + y / 16) % 4; }
+
+const Color GRAY_COLORS[] = {COLOR_ON, Color(170, 170, 170), Color(85, 85, 85), COLOR_OFF};
+
+// Draws gray_pattern() on a grayscale display, updates once and checks the decoded gray levels. The RAM may be wider
+// than the visible width.
+std::string run_grayscale(waveshare_epaper::WaveshareEPaper &display, int ram_width, int width, int height) {
+  FakePin dc("dc", false), reset("reset");
+  FakeBusyPin busy;
+  testing::Ssd168xModel model(ram_width, height, &busy);
+  FakeBus bus(&dc, &model);
+
+  display.set_dc_pin(&dc);
+  display.set_reset_pin(&reset);
+  display.set_busy_pin(&busy);
+  display.set_grayscale(true);
+  display.set_writer([width, height](display::Display &it) {
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++)
+        it.draw_pixel_at(x, y, GRAY_COLORS[gray_pattern(x, y)]);
+    }
+  });
+
+  bus.note("# setup");
+  display.setup();
+  testing::run_scheduler(200);
+
+  bus.note("# frame 1");
+  display.update();
+  testing::run_scheduler(2000);
+  bus.note(stats_line(display.get_spi_stats()));
+
+  expect(model.get_refreshes() == 1, "unexpected number of refreshes");
+  int wrong = 0;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      if (model.gray_level(x, y) != gray_pattern(x, y))
+        wrong++;
+    }
+  }
+  expect(wrong == 0, std::to_string(wrong) + " wrong gray levels in RAM");
+  expect(bus.get_nested_enables() == 0, "CS asserted twice");
+  return bus.get_trace();
+}
+
+// 2.9" V2 in TypeA with the 4-gray waveform
+std::string run_typea_2_9_v2_gray() {
+  waveshare_epaper::WaveshareEPaperTypeA display(waveshare_epaper::WAVESHARE_EPAPER_2_9_IN_V2);
+  return run_grayscale(display, 128, 128, 296);
+}
+
+// 2.13" V3 with the 4-gray waveform
+std::string run_2_13_v3_gray() {
+  waveshare_epaper::WaveshareEPaper2P13InV3 display;
+  return run_grayscale(display, 128, 122, 250);
+}
+
+struct Scenario {
+  const char *name;
+  std::string (*run)();
+};
+
+const Scenario SCENARIOS[] = {
+    {"typea_2_9_v2", run_typea_2_9_v2},
+    {"typea_2_9_v2_gray", run_typea_2_9_v2_gray},
+    {"2_13_v3_gray", run_2_13_v3_gray},
+    {"2_13_v3_partial", run_2_13_v3_partial},
+};
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  bool update = false;
+  std::string dir = "traces";
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--update") == 0) {
+      update = true;
+    } else if (strcmp(argv[i], "-v") == 0) {
+      log_level = LOG_LEVEL_VERBOSE;
+    } else {
+      dir = argv[i];
+    }
+  }
+
+  for (const Scenario &scenario : SCENARIOS) {
+    const int before = failures;
+    const std::string trace = scenario.run();
+    const std::string path = dir + "/" + scenario.name + ".trace";
+    if (update) {
+      std::ofstream(path) << trace;
+      printf("%s: trace written to %s\n", scenario.name, path.c_str());
+    } else {
+      std::ifstream file(path);
+      std::stringstream golden;
+      golden << file.rdbuf();
+      if (golden.str() != trace) {
+        std::ofstream(path + ".actual") << trace;
+        expect(false, std::string(scenario.name) + ": trace differs from " + path + ", see " + path + ".actual");
+      }
+    }
+    printf("%s: %s\n", scenario.name, failures == before ? "ok" : "FAILED");
+  }
+  return failures == 0 ? 0 : 1;
+}
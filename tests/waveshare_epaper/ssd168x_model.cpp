@@ -0,0 +1,116 @@
+#include "ssd168x_model.h"
+
+namespace esphome {
+namespace testing {
+
+Ssd168xModel::Ssd168xModel(int width, int height, FakeBusyPin *busy)
+    : width_bytes_((width + 7) / 8), height_(height), busy_(busy) {
+  this->x_end_ = this->width_bytes_ - 1;
+  this->y_end_ = height - 1;
+  for (auto &ram : this->ram_)
+    ram.assign(this->width_bytes_ * height, 0xFF);
+}
+
+void Ssd168xModel::on_command(uint8_t command) {
+  this->command_ = command;
+  this->index_ = 0;
+  switch (command) {
+    case 0x12:  // software reset
+      this->busy_->set_busy_for(RESET_BUSY_MS);
+      break;
+    case 0x20:  // master activation
+      this->busy_->set_busy_for(REFRESH_BUSY_MS);
+      this->refreshes_++;
+      break;
+    default:
+      break;
+  }
+}
+
+void Ssd168xModel::on_data(uint8_t data) {
+  const uint8_t index = this->index_++;
+  switch (this->command_) {
+    case 0x11:  // data entry mode
+      this->entry_mode_ = data;
+      break;
+    case 0x44:  // x window, in bytes
+      if (index == 0)
+        this->x_start_ = data;
+      if (index == 1)
+        this->x_end_ = data;
+      break;
+    case 0x45:  // y window
+      if (index == 0)
+        this->y_start_ = data;
+      if (index == 1)
+        this->y_start_ |= (data & 0x01) << 8;
+      if (index == 2)
+        this->y_end_ = data;
+      if (index == 3)
+        this->y_end_ |= (data & 0x01) << 8;
+      break;
+    case 0x4E:  // x address counter
+      this->x_ = data;
+      break;
+    case 0x4F:  // y address counter
+      if (index == 0)
+        this->y_ = data;
+      if (index == 1)
+        this->y_ |= (data & 0x01) << 8;
+      break;
+    case 0x24:
+    case 0x26:
+      this->write_ram_(data);
+      break;
+    default:
+      break;
+  }
+}
+
+void Ssd168xModel::write_ram_(uint8_t data) {
+  std::vector<uint8_t> &ram = this->ram_[this->command_ == 0x24 ? 0 : 1];
+  if (this->x_ >= 0 && this->x_ < this->width_bytes_ && this->y_ >= 0 && this->y_ < this->height_)
+    ram[this->y_ * this->width_bytes_ + this->x_] = data;
+
+  const bool x_inc = this->entry_mode_ & 0x01;
+  const bool y_inc = this->entry_mode_ & 0x02;
+  const int x_first = x_inc ? this->x_start_ : this->x_end_;
+  const int y_first = y_inc ? this->y_start_ : this->y_end_;
+  auto step_y = [&]() {
+    this->y_ += y_inc ? 1 : -1;
+    if (this->y_ < this->y_start_ || this->y_ > this->y_end_) {
+      this->y_ = y_first;
+      return true;
+    }
+    return false;
+  };
+  auto step_x = [&]() {
+    this->x_ += x_inc ? 1 : -1;
+    if (this->x_ < this->x_start_ || this->x_ > this->x_end_) {
+      this->x_ = x_first;
+      return true;
+    }
+    return false;
+  };
+  // AM: the address counter moves in y direction first
+  if (this->entry_mode_ & 0x04) {
+    if (step_y())
+      step_x();
+  } else if (step_x()) {
+    step_y();
+  }
+}
+
+bool Ssd168xModel::get_bit_(uint8_t ram, int x, int y) const {
+  const std::vector<uint8_t> &plane = this->ram_[ram == 0x24 ? 0 : 1];
+  return plane[y * this->width_bytes_ + x / 8] & (0x80 >> (x % 8));
+}
+
+bool Ssd168xModel::is_black(uint8_t ram, int x, int y) const { return !this->get_bit_(ram, x, y); }
+
+uint8_t Ssd168xModel::gray_level(int x, int y) const {
+  return (this->get_bit_(0x26, x, y) ? 0 : 2) | (this->get_bit_(0x24, x, y) ? 0 : 1);
+}
+
+}  // namespace testing
+}  // namespace esphome
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "fake_bus.h"
+
+namespace esphome {
+namespace testing {
+
+// Controller model of the SSD1680/SSD1681 family (2.13" V2/V3, 2.9" V2, ...): busy times of reset and refresh, and
+// the two RAM planes written through the data entry mode, window and address counters.
+class Ssd168xModel : public ControllerModel {
+ public:
+  Ssd168xModel(int width, int height, FakeBusyPin *busy);
+
+  void on_command(uint8_t command) override;
+  void on_data(uint8_t data) override;
+
+  // 0x24: black/white RAM, 0x26: red or previous frame RAM. Pixels are MSB first, a cleared bit is black.
+  bool is_black(uint8_t ram, int x, int y) const;
+  // Gray level written for the 4-gray waveform of the Waveshare demo, 0 is black and 3 white: 0x24 holds the inverted
+  // low bit, 0x26 the inverted high bit.
+  uint8_t gray_level(int x, int y) const;
+  uint32_t get_refreshes() const { return this->refreshes_; }
+
+  static const uint32_t RESET_BUSY_MS = 10;
+  static const uint32_t REFRESH_BUSY_MS = 1000;
+
+ protected:
+  void write_ram_(uint8_t data);
+  bool get_bit_(uint8_t ram, int x, int y) const;
+
+  int width_bytes_;
+  int height_;
+  FakeBusyPin *busy_;
+  std::vector<uint8_t> ram_[2];
+
+  uint8_t command_{0};
+  uint8_t index_{0};
+  uint8_t entry_mode_{0x03};
+  int x_start_{0}, x_end_{0}, y_start_{0}, y_end_{0};
+  int x_{0}, y_{0};
+  uint32_t refreshes_{0};
+};
+
+}  // namespace testing
+}  // namespace esphome
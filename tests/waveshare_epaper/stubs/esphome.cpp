@@ -0,0 +1,247 @@
+// Minimal host implementation of the ESPHome core parts used by the drivers: a simulated clock and scheduler, logging
+// and the generic display drawing code.
+#include "esphome/components/display/display_buffer.h"
+#include "esphome/core/application.h"
+#include "esphome/core/component.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+#include "../fake_bus.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace esphome {
+
+Application App;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+int log_level = LOG_LEVEL_NONE;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+namespace setup_priority {
+const float PROCESSOR = 400.0f;
+}  // namespace setup_priority
+
+void esp_log_printf_(int level, const char *tag, const char *format, ...) {
+  if (level > log_level)
+    return;
+  fprintf(stderr, "[%s] ", tag);
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+// ---------------- Clock and scheduler ----------------
+
+namespace {
+
+uint64_t now_us = 0;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+struct Task {
+  Component *component;
+  std::string name;
+  bool interval;
+  uint32_t period;
+  uint32_t next;
+  std::function<void()> callback;
+  bool removed;
+};
+
+std::vector<Task> tasks;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+bool cancel_task(Component *component, const std::string &name, bool interval) {
+  bool found = false;
+  for (auto &task : tasks) {
+    if (!task.removed && task.component == component && task.interval == interval && task.name == name) {
+      task.removed = true;
+      found = true;
+    }
+  }
+  return found;
+}
+
+void add_task(Component *component, const std::string &name, bool interval, uint32_t period,
+              std::function<void()> &&callback) {
+  if (!name.empty())
+    cancel_task(component, name, interval);
+  tasks.push_back({component, name, interval, period, millis() + period, std::move(callback), false});
+}
+
+}  // namespace
+
+uint32_t millis() { return static_cast<uint32_t>(now_us / 1000); }
+uint32_t micros() { return static_cast<uint32_t>(now_us); }
+void delay(uint32_t ms) { now_us += uint64_t(ms) * 1000; }
+void delayMicroseconds(uint32_t us) { now_us += us; }
+
+Component::~Component() {
+  for (auto &task : tasks) {
+    if (task.component == this)
+      task.removed = true;
+  }
+}
+void Component::set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f) {
+  add_task(this, name, false, timeout, std::move(f));
+}
+bool Component::cancel_timeout(const std::string &name) { return cancel_task(this, name, false); }
+void Component::set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f) {
+  add_task(this, name, true, interval, std::move(f));
+}
+bool Component::cancel_interval(const std::string &name) { return cancel_task(this, name, true); }
+
+namespace testing {
+
+void run_scheduler(uint32_t ms) {
+  const uint32_t end = millis() + ms;
+  while (static_cast<int32_t>(end - millis()) > 0) {
+    delay(1);
+    // callbacks may add tasks, so the vector can move under the loop
+    for (size_t i = 0; i < tasks.size(); i++) {
+      if (tasks[i].removed || static_cast<int32_t>(millis() - tasks[i].next) < 0)
+        continue;
+      std::function<void()> callback = tasks[i].callback;
+      if (tasks[i].interval) {
+        tasks[i].next += tasks[i].period;
+      } else {
+        tasks[i].removed = true;
+      }
+      callback();
+    }
+    tasks.erase(std::remove_if(tasks.begin(), tasks.end(), [](const Task &task) { return task.removed; }),
+                tasks.end());
+  }
+}
+
+}  // namespace testing
+
+// ---------------- Display ----------------
+
+namespace display {
+
+void Rect::shrink(Rect rect) {
+  if (!this->is_set()) {
+    *this = rect;
+    return;
+  }
+  if (!rect.is_set())
+    return;
+  const int16_t x2 = std::min(this->x2(), rect.x2());
+  const int16_t y2 = std::min(this->y2(), rect.y2());
+  this->x = std::max(this->x, rect.x);
+  this->y = std::max(this->y, rect.y);
+  this->w = std::max<int16_t>(x2 - this->x, 0);
+  this->h = std::max<int16_t>(y2 - this->y, 0);
+}
+bool Rect::inside(int16_t test_x, int16_t test_y, bool absolute) const {
+  if (!this->is_set())
+    return true;
+  if (absolute)
+    return test_x >= this->x && test_x < this->x2() && test_y >= this->y && test_y < this->y2();
+  return test_x >= 0 && test_x < this->w && test_y >= 0 && test_y < this->h;
+}
+
+void Display::fill(Color color) { this->filled_rectangle(0, 0, this->get_width(), this->get_height(), color); }
+void Display::horizontal_line(int x, int y, int width, Color color) {
+  for (int i = x; i < x + width; i++)
+    this->draw_pixel_at(i, y, color);
+}
+void Display::filled_rectangle(int x1, int y1, int width, int height, Color color) {
+  for (int y = y1; y < y1 + height; y++)
+    this->horizontal_line(x1, y, width, color);
+}
+void Display::draw_pixels_at(int x_start, int y_start, int w, int h, const uint8_t *ptr, ColorOrder order,
+                             ColorBitness bitness, bool big_endian, int x_offset, int y_offset, int x_pad) {
+  // only what the harness draws: RGB888 and RGB565
+  const int bytes = bitness == COLOR_BITNESS_888 ? 3 : 2;
+  const int line = x_offset + w + x_pad;
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      const uint8_t *p = ptr + ((y + y_offset) * line + x + x_offset) * bytes;
+      Color color;
+      if (bitness == COLOR_BITNESS_888) {
+        color = Color(p[0], p[1], p[2]);
+      } else {
+        const uint16_t v = big_endian ? (p[0] << 8) | p[1] : (p[1] << 8) | p[0];
+        color = Color(((v >> 11) & 0x1F) << 3, ((v >> 5) & 0x3F) << 2, (v & 0x1F) << 3);
+      }
+      this->draw_pixel_at(x_start + x, y_start + y, color);
+    }
+  }
+}
+void Display::start_clipping(Rect rect) {
+  if (!this->clipping_rectangle_.empty())
+    rect.shrink(this->clipping_rectangle_.back());
+  this->clipping_rectangle_.push_back(rect);
+}
+void Display::end_clipping() {
+  if (!this->clipping_rectangle_.empty())
+    this->clipping_rectangle_.pop_back();
+}
+Rect Display::get_clipping() const {
+  if (this->clipping_rectangle_.empty())
+    return Rect();
+  return this->clipping_rectangle_.back();
+}
+void Display::do_update_() {
+  if (this->auto_clear_enabled_)
+    this->clear();
+  if (this->writer_.has_value())
+    (*this->writer_)(*this);
+  this->clear_clipping_();
+}
+
+int DisplayBuffer::get_width() {
+  switch (this->rotation_) {
+    case DISPLAY_ROTATION_90_DEGREES:
+    case DISPLAY_ROTATION_270_DEGREES:
+      return this->get_height_internal();
+    default:
+      return this->get_width_internal();
+  }
+}
+int DisplayBuffer::get_height() {
+  switch (this->rotation_) {
+    case DISPLAY_ROTATION_90_DEGREES:
+    case DISPLAY_ROTATION_270_DEGREES:
+      return this->get_width_internal();
+    default:
+      return this->get_height_internal();
+  }
+}
+void DisplayBuffer::draw_pixel_at(int x, int y, Color color) {
+  if (!this->get_clipping().inside(x, y))
+    return;
+  switch (this->rotation_) {
+    case DISPLAY_ROTATION_0_DEGREES:
+      break;
+    case DISPLAY_ROTATION_90_DEGREES:
+      std::swap(x, y);
+      x = this->get_width_internal() - x - 1;
+      break;
+    case DISPLAY_ROTATION_180_DEGREES:
+      x = this->get_width_internal() - x - 1;
+      y = this->get_height_internal() - y - 1;
+      break;
+    case DISPLAY_ROTATION_270_DEGREES:
+      std::swap(x, y);
+      y = this->get_height_internal() - y - 1;
+      break;
+  }
+  this->draw_absolute_pixel_internal(x, y, color);
+}
+void DisplayBuffer::init_internal_(uint32_t buffer_length) {
+  RAMAllocator<uint8_t> allocator;
+  this->buffer_ = allocator.allocate(buffer_length);
+  if (this->buffer_ == nullptr) {
+    ESP_LOGE("display", "Could not allocate buffer for display!");
+    return;
+  }
+  this->clear();
+}
+
+}  // namespace display
+}  // namespace esphome
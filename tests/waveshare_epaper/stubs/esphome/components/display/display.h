@@ -0,0 +1,61 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "esphome/components/display/rect.h"
+#include "esphome/core/color.h"
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace display {
+
+enum DisplayType { DISPLAY_TYPE_BINARY = 1, DISPLAY_TYPE_GRAYSCALE = 2, DISPLAY_TYPE_COLOR = 3 };
+enum DisplayRotation {
+  DISPLAY_ROTATION_0_DEGREES = 0,
+  DISPLAY_ROTATION_90_DEGREES = 90,
+  DISPLAY_ROTATION_180_DEGREES = 180,
+  DISPLAY_ROTATION_270_DEGREES = 270,
+};
+enum ColorOrder : uint8_t { COLOR_ORDER_RGB = 0, COLOR_ORDER_BGR = 1, COLOR_ORDER_GRB = 2 };
+enum ColorBitness : uint8_t { COLOR_BITNESS_888 = 0, COLOR_BITNESS_565 = 1, COLOR_BITNESS_332 = 2 };
+
+class Display;
+using display_writer_t = std::function<void(Display &)>;
+
+// The parts of the ESPHome display API the drivers use, with the same semantics
+class Display : public PollingComponent {
+ public:
+  virtual void fill(Color color);
+  void clear() { this->fill(COLOR_OFF); }
+  virtual int get_width() = 0;
+  virtual int get_height() = 0;
+  virtual void draw_pixel_at(int x, int y, Color color) = 0;
+  virtual void draw_pixels_at(int x_start, int y_start, int w, int h, const uint8_t *ptr, ColorOrder order,
+                              ColorBitness bitness, bool big_endian, int x_offset, int y_offset, int x_pad);
+  void horizontal_line(int x, int y, int width, Color color = COLOR_ON);
+  void filled_rectangle(int x1, int y1, int width, int height, Color color = COLOR_ON);
+  virtual DisplayType get_display_type() = 0;
+
+  void set_writer(display_writer_t &&writer) { this->writer_ = std::move(writer); }
+  void set_rotation(DisplayRotation rotation) { this->rotation_ = rotation; }
+  DisplayRotation get_rotation() const { return this->rotation_; }
+  void set_auto_clear(bool auto_clear_enabled) { this->auto_clear_enabled_ = auto_clear_enabled; }
+
+  void start_clipping(Rect rect);
+  void end_clipping();
+  Rect get_clipping() const;
+  bool is_clipping() const { return !this->clipping_rectangle_.empty(); }
+
+ protected:
+  void do_update_();
+  void clear_clipping_() { this->clipping_rectangle_.clear(); }
+
+  DisplayRotation rotation_{DISPLAY_ROTATION_0_DEGREES};
+  optional<display_writer_t> writer_{};
+  bool auto_clear_enabled_{true};
+  std::vector<Rect> clipping_rectangle_;
+};
+
+}  // namespace display
+}  // namespace esphome
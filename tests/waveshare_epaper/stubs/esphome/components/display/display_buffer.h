@@ -0,0 +1,24 @@
+#pragma once
+
+#include "esphome/components/display/display.h"
+
+namespace esphome {
+namespace display {
+
+class DisplayBuffer : public Display {
+ public:
+  int get_width() override;
+  int get_height() override;
+  void draw_pixel_at(int x, int y, Color color) override;
+
+ protected:
+  virtual void draw_absolute_pixel_internal(int x, int y, Color color) = 0;
+  virtual int get_height_internal() = 0;
+  virtual int get_width_internal() = 0;
+  void init_internal_(uint32_t buffer_length);
+
+  uint8_t *buffer_{nullptr};
+};
+
+}  // namespace display
+}  // namespace esphome
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+namespace display {
+
+static const int16_t VALUE_NO_SET = 32766;
+
+class Rect {
+ public:
+  int16_t x, y, w, h;
+  Rect() : x(VALUE_NO_SET), y(VALUE_NO_SET), w(VALUE_NO_SET), h(VALUE_NO_SET) {}
+  Rect(int16_t x, int16_t y, int16_t w, int16_t h) : x(x), y(y), w(w), h(h) {}
+  int16_t x2() const { return this->x + this->w; }
+  int16_t y2() const { return this->y + this->h; }
+  bool is_set() const { return this->h != VALUE_NO_SET && this->w != VALUE_NO_SET; }
+  void shrink(Rect rect);
+  bool inside(int16_t test_x, int16_t test_y, bool absolute = true) const;
+};
+
+}  // namespace display
+}  // namespace esphome
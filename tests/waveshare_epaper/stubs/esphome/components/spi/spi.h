@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "esphome/core/gpio.h"
+
+namespace esphome {
+namespace spi {
+
+enum SPIBitOrder { BIT_ORDER_LSB_FIRST, BIT_ORDER_MSB_FIRST };
+enum SPIClockPolarity { CLOCK_POLARITY_LOW, CLOCK_POLARITY_HIGH };
+enum SPIClockPhase { CLOCK_PHASE_LEADING, CLOCK_PHASE_TRAILING };
+enum SPIDataRate : uint32_t { DATA_RATE_2MHZ = 2000000, DATA_RATE_20MHZ = 20000000 };
+
+// Host build: all SPI devices share the fake bus of the test harness
+void fake_bus_enable();
+void fake_bus_disable();
+void fake_bus_write(const uint8_t *data, size_t length);
+
+template<SPIBitOrder BIT_ORDER, SPIClockPolarity CLOCK_POLARITY, SPIClockPhase CLOCK_PHASE, SPIDataRate DATA_RATE>
+class SPIDevice {
+ public:
+  void spi_setup() {}
+  void enable() { fake_bus_enable(); }
+  void disable() { fake_bus_disable(); }
+  void write_byte(uint8_t data) { fake_bus_write(&data, 1); }
+  void write_array(const uint8_t *data, size_t length) { fake_bus_write(data, length); }
+
+ protected:
+  GPIOPin *cs_{nullptr};
+};
+
+}  // namespace spi
+}  // namespace esphome
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+
+struct Color {
+  union {
+    struct {
+      uint8_t r, g, b, w;
+    };
+    struct {
+      uint8_t red, green, blue, white;
+    };
+    uint32_t raw_32;
+  };
+  constexpr Color() : raw_32(0) {}
+  constexpr Color(uint8_t red, uint8_t green, uint8_t blue, uint8_t white = 0)
+      : r(red), g(green), b(blue), w(white) {}
+  bool is_on() const { return this->raw_32 != 0; }
+  bool operator==(const Color &other) const { return this->raw_32 == other.raw_32; }
+  bool operator!=(const Color &other) const { return this->raw_32 != other.raw_32; }
+};
+
+static const Color COLOR_OFF(0, 0, 0, 0);
+static const Color COLOR_ON(255, 255, 255, 255);
+
+}  // namespace esphome
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "esphome/core/gpio.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/optional.h"
+
+namespace esphome {
+
+namespace setup_priority {
+extern const float PROCESSOR;
+}  // namespace setup_priority
+
+class Component {
+ public:
+  virtual ~Component();
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+  virtual float get_setup_priority() const { return 0.0f; }
+  virtual void on_safe_shutdown() {}
+
+  void status_set_warning(const char *message = nullptr) { this->warning_ = true; }
+  void status_clear_warning() { this->warning_ = false; }
+  bool status_has_warning() const { return this->warning_; }
+  void mark_failed() { this->failed_ = true; }
+  bool is_failed() const { return this->failed_; }
+
+ protected:
+  // Run by the simulated scheduler, see testing::run_scheduler()
+  void set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f);
+  void set_timeout(uint32_t timeout, std::function<void()> &&f) { this->set_timeout("", timeout, std::move(f)); }
+  bool cancel_timeout(const std::string &name);
+  void set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f);
+  void set_interval(uint32_t interval, std::function<void()> &&f) { this->set_interval("", interval, std::move(f)); }
+  bool cancel_interval(const std::string &name);
+
+  bool warning_{false};
+  bool failed_{false};
+};
+
+class PollingComponent : public Component {
+ public:
+  virtual void update() = 0;
+  uint32_t get_update_interval() const { return this->update_interval_; }
+  void set_update_interval(uint32_t update_interval) { this->update_interval_ = update_interval; }
+
+ protected:
+  uint32_t update_interval_{60000};
+};
+
+}  // namespace esphome
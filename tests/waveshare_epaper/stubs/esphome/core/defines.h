@@ -0,0 +1,3 @@
+#pragma once
+
+// Host build: no optional components, no ESP32 task support
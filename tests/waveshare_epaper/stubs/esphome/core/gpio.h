@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+
+class GPIOPin {
+ public:
+  virtual ~GPIOPin() = default;
+  virtual void setup() {}
+  virtual bool digital_read() { return false; }
+  virtual void digital_write(bool value) {}
+};
+
+}  // namespace esphome
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#define PROGMEM
+#define HOT
+
+namespace esphome {
+
+// Simulated clock, only delay() and the harness advance it
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+inline uint8_t progmem_read_byte(const uint8_t *addr) { return *addr; }
+inline uint16_t progmem_read_uint16(const uint16_t *addr) { return *addr; }
+
+}  // namespace esphome
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "esphome/core/hal.h"
+
+namespace esphome {
+
+template<class T> class RAMAllocator {
+ public:
+  enum Flags { NONE = 0, ALLOC_EXTERNAL = 1, ALLOC_INTERNAL = 2, ALLOW_FAILURE = 4 };
+  RAMAllocator() = default;
+  RAMAllocator(uint8_t flags) {}
+  T *allocate(size_t n) { return static_cast<T *>(malloc(n * sizeof(T))); }
+  void deallocate(T *p, size_t n) { free(p); }
+};
+
+constexpr uint32_t encode_uint32(uint8_t byte1, uint8_t byte2, uint8_t byte3, uint8_t byte4) {
+  return (uint32_t(byte1) << 24) | (uint32_t(byte2) << 16) | (uint32_t(byte3) << 8) | uint32_t(byte4);
+}
+
+#define YESNO(b) ((b) ? "YES" : "NO")
+#define ONOFF(b) ((b) ? "ON" : "OFF")
+
+}  // namespace esphome
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cinttypes>
+
+namespace esphome {
+
+enum LogLevel : int {
+  LOG_LEVEL_NONE = 0,
+  LOG_LEVEL_ERROR,
+  LOG_LEVEL_WARN,
+  LOG_LEVEL_INFO,
+  LOG_LEVEL_CONFIG,
+  LOG_LEVEL_DEBUG,
+  LOG_LEVEL_VERBOSE,
+  LOG_LEVEL_VERY_VERBOSE,
+};
+
+// Messages up to this level go to stderr, set by the harness
+extern int log_level;
+
+void esp_log_printf_(int level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+}  // namespace esphome
+
+#define ESP_LOGE(tag, ...) ::esphome::esp_log_printf_(::esphome::LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) ::esphome::esp_log_printf_(::esphome::LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) ::esphome::esp_log_printf_(::esphome::LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) ::esphome::esp_log_printf_(::esphome::LOG_LEVEL_CONFIG, tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) ::esphome::esp_log_printf_(::esphome::LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) ::esphome::esp_log_printf_(::esphome::LOG_LEVEL_VERBOSE, tag, __VA_ARGS__)
+#define ESP_LOGVV(tag, ...) ::esphome::esp_log_printf_(::esphome::LOG_LEVEL_VERY_VERBOSE, tag, __VA_ARGS__)
+
+#define LOG_PIN(prefix, pin) (void) (pin)
+#define LOG_UPDATE_INTERVAL(component) (void) (component)
+#define LOG_DISPLAY(prefix, type, display) (void) (display)
+#define LOG_SENSOR(prefix, type, sensor) (void) (sensor)